@@ -0,0 +1,127 @@
+/*
+  Compares the write and space amplification of the LEVELED and TIERED
+  compaction styles. Every run writes the same random overwrites into a fresh
+  Storage, flushes and compacts until the picker is done, then measures:
+  - write amplification, the SST bytes written by flushes and compactions
+    over the bytes put by the user,
+  - space amplification, the SST bytes on disk over the bytes of the live
+    key-value pairs.
+
+  usage: compaction_bench [total_puts] [key_space] [value_size]
+*/
+#include "storage.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Result {
+  double puts_per_sec;
+  double write_amplification;
+  double space_amplification;
+  uint64_t compaction_count;
+  uint64_t sorted_runs;
+};
+
+std::vector<std::byte> make_key(uint64_t idx) {
+  auto str = std::to_string(idx);
+  str.insert(0, 16 - str.size(), '0');
+  std::vector<std::byte> key;
+  key.reserve(str.size());
+  for (char ch : str) {
+    key.push_back(static_cast<std::byte>(ch));
+  }
+  return key;
+}
+
+Result run(CompactionStyle style, uint64_t total_puts, uint64_t key_space,
+           size_t value_size) {
+  auto directory =
+      std::filesystem::temp_directory_path() / "mini_lsm_compaction_bench";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  StorageOption opt{.mem_table_size_ = 256 * 1024,
+                    .compaction_style_ = style,
+                    .max_bytes_for_level_base_ = 1 << 20,
+                    .target_file_size_ = 256 * 1024,
+                    .sst_directory_ = directory / "sst",
+                    .manifest_directory_ = directory / "manifest",
+                    .wal_directory_ = directory / "wal"};
+
+  Result result{};
+  {
+    Storage storage(opt);
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uint64_t> dist(0, key_space - 1);
+    std::vector<std::byte> value(value_size, std::byte{'v'});
+    uint64_t user_bytes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < total_puts; i++) {
+      auto key = make_key(dist(rng));
+      user_bytes += key.size() + value.size();
+      storage.put(key, value);
+    }
+    storage.flush_run(true);
+    storage.compact_run();
+    auto elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start);
+    result.puts_per_sec = static_cast<double>(total_puts) / elapsed.count();
+
+    auto stats = storage.get_stats();
+    result.write_amplification =
+        static_cast<double>(stats.flush_bytes_written_ +
+                            stats.compaction_bytes_written_) /
+        user_bytes;
+    result.compaction_count = stats.compaction_count_;
+    result.sorted_runs = stats.level_file_count_[0];
+    for (size_t level = 1; level < stats.level_file_count_.size(); level++) {
+      result.sorted_runs += stats.level_file_count_[level] > 0;
+    }
+
+    uint64_t live_bytes = 0;
+    for (auto iter = storage.scan({}, {}); iter.is_valid(); iter.next()) {
+      live_bytes += iter.key_view().size() + iter.value_view().size();
+    }
+    uint64_t disk_bytes = 0;
+    for (auto &entry :
+         std::filesystem::directory_iterator(opt.sst_directory_)) {
+      disk_bytes += entry.file_size();
+    }
+    result.space_amplification =
+        static_cast<double>(disk_bytes) / std::max<uint64_t>(live_bytes, 1);
+  }
+  std::filesystem::remove_all(directory);
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  uint64_t total_puts =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 19;
+  uint64_t key_space =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1 << 17;
+  size_t value_size = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100;
+
+  std::printf("%8s %14s %10s %10s %12s %12s\n", "style", "puts/sec",
+              "write-amp", "space-amp", "compactions", "sorted-runs");
+  for (auto [style, name] :
+       {std::pair{CompactionStyle::LEVELED, "leveled"},
+        std::pair{CompactionStyle::TIERED, "tiered"}}) {
+    auto result = run(style, total_puts, std::max<uint64_t>(key_space, 1),
+                      value_size);
+    std::printf("%8s %14.0f %10.2f %10.2f %12lu %12lu\n", name,
+                result.puts_per_sec, result.write_amplification,
+                result.space_amplification, result.compaction_count,
+                result.sorted_runs);
+  }
+  return 0;
+}
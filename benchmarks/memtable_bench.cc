@@ -0,0 +1,78 @@
+/*
+  Measures MemTable::put throughput while scaling the number of writer
+  threads from 1 to 32. Every thread writes its own disjoint set of keys
+  into one shared memtable.
+
+  usage: memtable_bench [total_puts] [value_size]
+*/
+#include "memtable.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<std::byte> make_key(uint64_t thread_id, uint64_t idx) {
+  // mix the index so that consecutive puts land on random skiplist positions
+  uint64_t mixed = (idx * 0x9E3779B97F4A7C15ULL) ^ (thread_id << 56);
+  auto str = std::to_string(mixed);
+  std::vector<std::byte> key;
+  key.reserve(str.size());
+  for (char ch : str) {
+    key.push_back(static_cast<std::byte>(ch));
+  }
+  return key;
+}
+
+double run(int n_threads, uint64_t total_puts, size_t value_size) {
+  MemTable mem_table{UINT64_MAX};
+  const uint64_t puts_per_thread = total_puts / n_threads;
+
+  std::vector<std::vector<std::vector<std::byte>>> keys(n_threads);
+  for (int t = 0; t < n_threads; t++) {
+    keys[t].reserve(puts_per_thread);
+    for (uint64_t i = 0; i < puts_per_thread; i++) {
+      keys[t].emplace_back(make_key(t, i));
+    }
+  }
+  std::vector<std::byte> value(value_size, std::byte{'v'});
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (auto &key : keys[t]) {
+        mem_table.put(key, value);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start);
+  return static_cast<double>(puts_per_thread * n_threads) / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  uint64_t total_puts =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+  size_t value_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+
+  std::printf("%8s %16s %10s\n", "threads", "puts/sec", "speedup");
+  double baseline = 0;
+  for (int n_threads : {1, 2, 4, 8, 16, 32}) {
+    double throughput = run(n_threads, total_puts, value_size);
+    if (n_threads == 1) {
+      baseline = throughput;
+    }
+    std::printf("%8d %16.0f %9.2fx\n", n_threads, throughput,
+                throughput / baseline);
+  }
+  return 0;
+}
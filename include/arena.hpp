@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Bump-pointer allocator backing a single memtable.
+ *
+ * Memory is carved out of fixed-size chunks and is never freed individually,
+ * every chunk is released at once when the arena is destroyed. Requests
+ * larger than a quarter of a chunk get a dedicated chunk so that they do not
+ * waste the tail of the current one.
+ *
+ * allocate() is thread-safe and lock-free while the current chunk has room,
+ * it is a single fetch_add on the chunk's offset. The mutex is only taken to
+ * install a new chunk.
+ */
+class Arena {
+public:
+  static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+  explicit Arena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // returned memory is aligned to alignof(std::max_align_t)
+  std::byte *allocate(size_t bytes);
+
+  // bytes handed out so far, including alignment padding and the unused tail
+  // of chunks that have been retired. The untouched tail of the current chunk
+  // is not counted.
+  size_t memory_usage() const;
+
+private:
+  struct Chunk {
+    explicit Chunk(size_t size)
+        : data_(new std::byte[size]), size_(size), used_(0) {}
+
+    std::unique_ptr<std::byte[]> data_;
+    size_t size_;
+    // bumped past size_ by the allocation that does not fit, and by every
+    // allocation racing with it, until the chunk is replaced
+    std::atomic<size_t> used_;
+  };
+
+  std::byte *allocate_fallback(size_t bytes, Chunk *current);
+  Chunk *allocate_chunk(size_t bytes);
+
+private:
+  // mu_ protects chunks_ and the installation of current_
+  std::mutex mu_;
+  size_t chunk_size_;
+  std::atomic<Chunk *> current_;
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  // bytes of the retired chunks and the dedicated chunks
+  std::atomic<size_t> memory_usage_;
+};
@@ -0,0 +1,197 @@
+#pragma once
+#include "sst/sst_builder.hpp"
+#include "sst/table_cache.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+// SSTs of one level. Level 0 is kept oldest first and its SSTs may overlap,
+// the deeper levels are sorted by key and their SSTs never overlap.
+using LevelFiles = std::vector<std::shared_ptr<const SSTHandle>>;
+
+// index of the SST of a sorted level whose key range may hold key,
+// level.size() when there is none
+size_t find_file(const LevelFiles &level, std::span<const std::byte> key);
+
+enum class CompactionStyle {
+  // one sorted run per level, every level a multiple of the previous one.
+  // Bounds read and space amplification, rewrites data at every level.
+  LEVELED,
+  // size-tiered: whole sorted runs of similar size are merged together.
+  // Writes less than LEVELED for more sorted runs and space.
+  TIERED,
+};
+
+struct CompactionOptions {
+  CompactionStyle style_{CompactionStyle::LEVELED};
+  uint64_t num_levels_{7};
+  // LEVELED: level 0 is compacted into level 1 once it holds this many SSTs.
+  // TIERED: compaction starts once there are this many sorted runs.
+  uint64_t level0_file_num_compaction_trigger_{4};
+  // LEVELED: target size of level 1, every deeper level is
+  // max_bytes_for_level_multiplier_ times larger than the previous one
+  uint64_t max_bytes_for_level_base_{256 * 1024};
+  uint64_t max_bytes_for_level_multiplier_{10};
+  // compaction outputs are split into SSTs of about this size
+  uint64_t target_file_size_{64 * 1024};
+  // TIERED: every sorted run is merged once the runs newer than the oldest
+  // one add up to this percentage of its size
+  uint64_t max_size_amplification_percent_{200};
+  // TIERED: a sorted run joins the newer runs picked before it while it is
+  // at most size_ratio_ percent larger than their total
+  uint64_t size_ratio_{1};
+  // TIERED: fewest sorted runs merged by a size ratio compaction
+  uint64_t min_merge_width_{2};
+};
+
+// SSTs of one level taken by a compaction
+struct CompactionInput {
+  uint64_t level_;
+  // in the order of the level
+  LevelFiles files_;
+};
+
+// SSTs merged by one compaction
+struct Compaction {
+  // by level, level 0 first
+  std::vector<CompactionInput> inputs_;
+  uint64_t output_level_;
+  // no level below output_level_ overlaps the inputs, so tombstones have
+  // nothing left to shadow and are dropped
+  bool bottommost_{false};
+
+  // a single SST only changes level, without being rewritten
+  bool is_trivial_move() const;
+  // every input, newest first as MergeIterator expects
+  LevelFiles all_inputs() const;
+};
+
+class CompactionPicker {
+public:
+  static std::unique_ptr<CompactionPicker> create(CompactionOptions opt);
+  virtual ~CompactionPicker() = default;
+  // nullopt when the levels need no compaction
+  virtual std::optional<Compaction>
+  pick(const std::vector<LevelFiles> &levels) = 0;
+};
+
+/**
+ * @brief Picks the next leveled compaction from the shape of the levels.
+ *
+ * Every level gets a score, the number of SSTs over the trigger for level 0
+ * and the size over the target size for the deeper levels. The level with
+ * the highest score of at least 1 is merged into the next one: all of level
+ * 0 at once, one SST at a time for the deeper levels, going round their key
+ * space. The last level is never compacted.
+ */
+class LeveledCompactionPicker : public CompactionPicker {
+public:
+  LeveledCompactionPicker(CompactionOptions opt = {});
+  std::optional<Compaction>
+  pick(const std::vector<LevelFiles> &levels) override;
+  double score(const std::vector<LevelFiles> &levels, uint64_t level) const;
+  uint64_t max_bytes_for_level(uint64_t level) const;
+
+private:
+  CompactionOptions opt_;
+  // per level, the largest key of the last SST compacted out of it
+  std::vector<std::vector<std::byte>> compact_pointer_;
+};
+
+/**
+ * @brief Picks size-tiered compactions that merge whole sorted runs.
+ *
+ * Every level 0 SST is a sorted run, and so is every non-empty deeper level.
+ * From newest to oldest they are level 0 newest first, then level 1, 2 and
+ * so on. Once there are level0_file_num_compaction_trigger_ runs:
+ * - every run is merged when the space amplification is too high,
+ * - otherwise the first streak of runs of similar size (size_ratio_) is,
+ * - otherwise the newest runs are, enough to fall below the trigger.
+ *
+ * The output takes the level of the oldest merged run. Level 0 runs leave
+ * level 0 together with every older level 0 run and go to the deepest empty
+ * level above the next older run, which is merged in as well when it sits
+ * at level 1.
+ */
+class TieredCompactionPicker : public CompactionPicker {
+public:
+  TieredCompactionPicker(CompactionOptions opt = {});
+  std::optional<Compaction>
+  pick(const std::vector<LevelFiles> &levels) override;
+
+private:
+  struct SortedRun {
+    uint64_t level_;
+    LevelFiles files_;
+    uint64_t size_;
+  };
+
+private:
+  // newest first
+  static std::vector<SortedRun>
+  sorted_runs(const std::vector<LevelFiles> &levels);
+  // merges the runs [first, last], extended to keep the levels in age order
+  static Compaction make_compaction(const std::vector<LevelFiles> &levels,
+                                    const std::vector<SortedRun> &runs,
+                                    size_t first, size_t last);
+  std::optional<Compaction>
+  pick_size_ratio(const std::vector<LevelFiles> &levels,
+                  const std::vector<SortedRun> &runs) const;
+
+private:
+  CompactionOptions opt_;
+};
+
+/**
+ * @brief Merges the inputs of a compaction into new SSTs.
+ *
+ * The newest version of every key is kept and the outputs are cut once they
+ * reach target_file_size. A key never spans two outputs.
+ *
+ * With a thread pool, the key space is split into up to max_subcompactions
+ * ranges holding about the same input bytes, cut at the last keys of the
+ * input blocks. Every range is merged on its own thread and the outputs are
+ * returned together, in key order.
+ */
+class CompactionJob {
+public:
+  // new_file_id allocates the id of every output SST, concurrently when the
+  // compaction is split
+  CompactionJob(const Compaction &compaction, TableCache &table_cache,
+                SSTConfig sst_config, uint64_t target_file_size,
+                std::function<uint64_t()> new_file_id,
+                uint64_t max_subcompactions = 1,
+                ThreadPool *thread_pool = nullptr);
+  // the outputs in key order
+  std::vector<std::shared_ptr<SST>> run();
+  uint64_t bytes_read() const;
+  uint64_t bytes_written() const;
+  // number of key ranges the last run was split into
+  size_t subcompactions() const;
+
+private:
+  // keys splitting the inputs into at most max_subcompactions_ ranges
+  std::vector<std::vector<std::byte>>
+  partition_boundaries(const std::vector<std::shared_ptr<SST>> &inputs) const;
+  // merges the keys of [lower, upper), an empty bound is no bound
+  std::vector<std::shared_ptr<SST>>
+  merge(const std::vector<std::shared_ptr<SST>> &inputs,
+        std::span<const std::byte> lower, std::span<const std::byte> upper,
+        uint64_t &bytes_written) const;
+
+private:
+  const Compaction &compaction_;
+  TableCache &table_cache_;
+  SSTConfig sst_config_;
+  uint64_t target_file_size_;
+  std::function<uint64_t()> new_file_id_;
+  uint64_t max_subcompactions_;
+  ThreadPool *thread_pool_;
+  uint64_t bytes_read_{0};
+  uint64_t bytes_written_{0};
+  size_t subcompactions_{0};
+};
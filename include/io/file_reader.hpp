@@ -1,21 +1,56 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <span>
+#include <sys/uio.h>
 #include <vector>
 
 namespace fs = std::filesystem;
 
+/**
+ * @brief Positional reader over a raw file descriptor.
+ *
+ * Reads go through pread and never touch a shared file position, so any
+ * number of threads can read through the same FileReader concurrently.
+ * With the IO_URING backend, batched reads are submitted together through
+ * the calling thread's io_uring and fall back to pread when io_uring is not
+ * available.
+ */
 class FileReader {
 public:
-  FileReader(const fs::path &path);
+  enum class Backend { PREAD, IO_URING };
+
+  struct ReadRequest {
+    uint64_t offset_;
+    // filled with buffer_.size() bytes read at offset_
+    std::span<std::byte> buffer_;
+  };
+
+public:
+  FileReader(const fs::path &path, Backend backend = Backend::PREAD);
+  FileReader(const FileReader &) = delete;
+  FileReader &operator=(const FileReader &) = delete;
   void read(size_t offsets, size_t length, std::vector<std::byte> &buffer);
+  // serves every request. With pread, requests over adjacent file ranges are
+  // coalesced into a single preadv, with io_uring they are all in flight at
+  // once.
+  void read_batch(std::span<ReadRequest> requests);
+  // the backend batched reads really use, IO_URING only if the kernel has it
+  Backend backend() const;
   void close();
   uint64_t file_size();
   ~FileReader();
 
 private:
-  std::ifstream in_;
+  void ensure_open() const;
+  void preadv_batch(std::span<ReadRequest> requests);
+  // reads exactly the iovecs' total size at offset, retrying short reads
+  void read_all(std::span<iovec> iovecs, uint64_t offset);
+
+private:
   fs::path path_name_;
+  int fd_{-1};
   uint64_t file_size_;
+  Backend backend_;
 };
@@ -30,3 +30,6 @@ private:
   void ensure_open() const;
   void write_all(const std::byte *data, std::size_t size);
 };
+
+// makes a rename or a new file in directory durable
+void sync_directory(const fs::path &directory);
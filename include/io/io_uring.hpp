@@ -0,0 +1,61 @@
+#pragma once
+#include "io/file_reader.hpp"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * @brief Minimal io_uring instance that reads many ranges of a file at once.
+ *
+ * Talks to the kernel through the raw io_uring_setup/io_uring_enter syscalls,
+ * there is no liburing dependency. Each thread gets its own ring from
+ * for_this_thread(), so submissions never need a lock.
+ */
+class IoUring {
+public:
+  static const unsigned QUEUE_DEPTH = 64;
+
+  // nullptr when the kernel or the sandbox does not allow io_uring
+  static IoUring *for_this_thread();
+
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+  /**
+   * @brief Reads every request, keeping up to QUEUE_DEPTH of them in flight,
+   * and waits for all of them to complete.
+   *
+   * Returns the indices of the requests that were not read in full, e.g. a
+   * short read or an opcode the kernel rejected. Those requests are advanced
+   * past the bytes that were read, the caller finishes them synchronously.
+   */
+  std::vector<size_t> read(int fd, std::span<FileReader::ReadRequest> requests);
+  ~IoUring();
+
+private:
+  IoUring() = default;
+  static IoUring *create();
+  // submits to_submit queued entries, counting them in submitted, and waits
+  // until wait_nr completed. Returns 0 or the errno of a fatal failure.
+  int enter(unsigned to_submit, unsigned wait_nr, unsigned &submitted);
+
+private:
+  int ring_fd_{-1};
+  unsigned sq_entries_{0};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+};
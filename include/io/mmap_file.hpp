@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Read-only mapping of a whole file.
+ *
+ * Reads are plain memory accesses into data(), served from the page cache
+ * without syscalls or copies. The mapping is advised RANDOM, which suits
+ * point lookups, and switches to SEQUENTIAL while at least one sequential
+ * reader is registered so the kernel reads ahead for scans.
+ */
+class MmapFile {
+public:
+  MmapFile(const fs::path &path);
+  MmapFile(const MmapFile &) = delete;
+  MmapFile &operator=(const MmapFile &) = delete;
+  std::span<const std::byte> data() const;
+  uint64_t file_size() const;
+  void begin_sequential_read();
+  void end_sequential_read();
+  ~MmapFile();
+
+private:
+  void advise(int advice);
+
+private:
+  fs::path path_name_;
+  std::byte *data_{nullptr};
+  uint64_t file_size_;
+  std::atomic<uint32_t> sequential_readers_{0};
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <expected>
+#include <span>
 #include <vector>
 
 /*
@@ -10,8 +11,21 @@
 class Iterator {
 public:
   virtual void next() = 0;
-  virtual std::vector<std::byte> key() = 0;
-  virtual std::vector<std::byte> value() = 0;
+  // positions the iterator at the first entry with key >= target
+  virtual void seek(const std::vector<std::byte> &target) = 0;
+  // views into memory pinned by the iterator, they stay valid until the next
+  // call to next() or seek()
+  virtual std::span<const std::byte> key_view() = 0;
+  virtual std::span<const std::byte> value_view() = 0;
+  // owning copies of key_view() and value_view()
+  std::vector<std::byte> key() {
+    auto view = key_view();
+    return std::vector<std::byte>(view.begin(), view.end());
+  }
+  std::vector<std::byte> value() {
+    auto view = value_view();
+    return std::vector<std::byte>(view.begin(), view.end());
+  }
   virtual bool is_valid() = 0;
   virtual ~Iterator() {};
 };
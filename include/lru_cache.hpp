@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Thread-safe LRU cache split into independently locked shards.
+ *
+ * A key always maps to the same shard, each shard owns capacity / n_shards
+ * of the total charge and evicts its least recently used entries once it
+ * goes over. An entry whose charge does not fit in a shard is not cached.
+ *
+ * Value is copied out on lookup, it is meant to be a handle such as a
+ * shared_ptr so that evicting an entry never invalidates it for a reader.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLRUCache {
+public:
+  static const size_t DEFAULT_SHARDS = 16;
+
+  explicit ShardedLRUCache(size_t capacity, size_t n_shards = DEFAULT_SHARDS)
+      : capacity_(capacity) {
+    n_shards = n_shards == 0 ? 1 : n_shards;
+    shards_.reserve(n_shards);
+    for (size_t i = 0; i < n_shards; i++) {
+      shards_.push_back(std::make_unique<Shard>(capacity / n_shards));
+    }
+  }
+  ShardedLRUCache(const ShardedLRUCache &) = delete;
+  ShardedLRUCache &operator=(const ShardedLRUCache &) = delete;
+
+  std::optional<Value> lookup(const Key &key) {
+    auto &shard = get_shard(key);
+    std::lock_guard lk{shard.mu_};
+    auto it = shard.index_.find(key);
+    if (it == shard.index_.end()) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    // move to the most recently used position
+    shard.lru_.splice(shard.lru_.begin(), shard.lru_, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->value_;
+  }
+
+  // replaces the value already cached under key, if any
+  void insert(const Key &key, Value value, size_t charge) {
+    auto &shard = get_shard(key);
+    if (charge > shard.capacity_) {
+      return;
+    }
+
+    std::lock_guard lk{shard.mu_};
+    auto it = shard.index_.find(key);
+    if (it != shard.index_.end()) {
+      shard.usage_ -= it->second->charge_;
+      shard.lru_.erase(it->second);
+      shard.index_.erase(it);
+    }
+
+    shard.lru_.push_front(
+        Entry{.key_ = key, .value_ = std::move(value), .charge_ = charge});
+    shard.index_.emplace(key, shard.lru_.begin());
+    shard.usage_ += charge;
+    while (shard.usage_ > shard.capacity_) {
+      auto &victim = shard.lru_.back();
+      shard.usage_ -= victim.charge_;
+      shard.index_.erase(victim.key_);
+      shard.lru_.pop_back();
+    }
+  }
+
+  void erase(const Key &key) {
+    auto &shard = get_shard(key);
+    std::lock_guard lk{shard.mu_};
+    auto it = shard.index_.find(key);
+    if (it == shard.index_.end()) {
+      return;
+    }
+    shard.usage_ -= it->second->charge_;
+    shard.lru_.erase(it->second);
+    shard.index_.erase(it);
+  }
+
+  // total charge of the cached entries
+  size_t usage() {
+    size_t usage = 0;
+    for (auto &shard : shards_) {
+      std::lock_guard lk{shard->mu_};
+      usage += shard->usage_;
+    }
+    return usage;
+  }
+
+  size_t capacity() const { return capacity_; }
+  uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+  struct Entry {
+    Key key_;
+    Value value_;
+    size_t charge_;
+  };
+
+  struct Shard {
+    explicit Shard(size_t capacity) : capacity_(capacity), usage_(0) {}
+
+    std::mutex mu_;
+    // most recently used first
+    std::list<Entry> lru_;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+    size_t capacity_;
+    size_t usage_;
+  };
+
+private:
+  Shard &get_shard(const Key &key) {
+    // fold the high bits in, std::hash of an integer can be the identity
+    uint64_t h = Hash{}(key);
+    return *shards_[(h ^ (h >> 32)) % shards_.size()];
+  }
+
+private:
+  size_t capacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
@@ -1,18 +1,44 @@
 #pragma once
 #include "io/file_writer.hpp"
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <set>
+#include <span>
 #include <utility>
 #include <vector>
 
 class FileReader;
 class VersionEdit;
 
+/**
+ * @brief Log of VersionEdits, replaying every record rebuilds the levels and
+ * the live WALs.
+ *
+ * The directory holds the manifest files, MANIFEST-<number>, and CURRENT,
+ * which names the live one. rewrite() starts a new manifest holding only a
+ * snapshot of the state and renames a new CURRENT over the old one, so a
+ * crash leaves either the old or the new manifest live.
+ *
+ * manifest encoded format:
+ * record | ... | record
+ *
+ * record encoded format:
+ *  payload_len (4 bytes) | crc32c of payload (4 bytes) | VersionEdit
+ *
+ * A record torn by a crash at the tail of the manifest was never
+ * acknowledged, recover drops it. A checksum mismatch before the tail is
+ * corruption and throws.
+ */
 class Manifest {
 public:
   static std::pair<Manifest, std::vector<VersionEdit>>
-  recover(const std::filesystem::path &path);
+  recover(const std::filesystem::path &directory);
   void add_record(const VersionEdit &record);
+  // replaces the records of the manifest by the snapshot ones
+  void rewrite(std::span<const VersionEdit> snapshot);
+  // bytes of the live manifest file
+  uint64_t file_size() const;
 
   Manifest() = default;
   //  Manifest(const Manifest &other) = delete;
@@ -20,8 +46,21 @@ public:
   //  Manifest &operator=(const Manifest &) = delete; // No copy assignment
   //  Manifest &operator=(Manifest &&) = default;     // Move assignment
 private:
-  Manifest(const std::filesystem::path &path);
+  static const uint32_t RECORD_LENGTH_ENCODED_SIZE = 4;
+  static const uint32_t RECORD_CHECKSUM_ENCODED_SIZE = 4;
 
 private:
+  Manifest(const std::filesystem::path &directory, uint64_t manifest_number);
+  static void encode_record(const VersionEdit &record,
+                            std::vector<std::byte> &out);
+  static std::filesystem::path manifest_path(const std::filesystem::path &dir,
+                                             uint64_t manifest_number);
+  // points CURRENT at MANIFEST-<manifest_number>
+  void write_current(uint64_t manifest_number) const;
+
+private:
+  std::filesystem::path directory_;
+  uint64_t manifest_number_{0};
   std::unique_ptr<FileWriter> writer_;
+  uint64_t file_size_{0};
 };
@@ -1,17 +1,17 @@
 #pragma once
 
 #include "iterator.hpp"
+#include "skiplist.hpp"
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
-#include <map>
-#include <mutex>
+#include <memory>
 #include <optional>
-#include <shared_mutex>
 #include <string>
 #include <vector>
 
-using MemTableStorage =
-    std::map<std::vector<std::byte>, std::vector<std::byte>>;
+using MemTableStorage = SkipList;
 
 class SST;
 class ImmutableMemTableIterator;
@@ -19,9 +19,12 @@ class SSTConfig;
 
 // TODO: create two class ImmutableMemTable and MutableMemTable.
 // ImmutableMemTable can only be read.
+// get/put can be called concurrently from many threads without locking, the
+// ordering between concurrent puts of the same key is up to the caller.
 class MemTable {
 public:
   enum class Status { Mutable, Immutable };
+  static const size_t MIN_ARENA_CHUNK_SIZE = 1024;
 
 public:
   static std::unique_ptr<MemTable> recover(const std::filesystem::path &path,
@@ -29,50 +32,69 @@ public:
 
 public:
   MemTable(uint64_t size, uint64_t id = 0);
-  std::optional<std::vector<std::byte>> get(const std::vector<std::byte> &key);
+  // only the writes with a sequence number <= sequence are seen
+  std::optional<std::vector<std::byte>>
+  get(const std::vector<std::byte> &key,
+      uint64_t sequence = MemTableStorage::MAX_SEQUENCE);
   void put(const std::vector<std::byte> &key,
-           const std::vector<std::byte> &value);
-  uint64_t size() {
-    std::shared_lock lk{shared_mu_};
-    return approximate_size_;
-  }
+           const std::vector<std::byte> &value, uint64_t sequence = 0);
+  // bytes allocated from the memtable's arena, including node and key/value
+  // overhead.
+  uint64_t size() const { return storage_->memory_usage(); }
 
   void freeze() {
-    std::lock_guard lk{shared_mu_};
-    status_ = Status::Immutable;
+    frozen_at_ = std::chrono::steady_clock::now();
+    status_.store(Status::Immutable, std::memory_order_release);
+  }
+  // time freeze() was called, only meaningful for immutable memtables
+  std::chrono::steady_clock::time_point get_frozen_time() const {
+    return frozen_at_;
   }
 
   ImmutableMemTableIterator get_iteartor();
+  // unlike get_iteartor, also allowed on a mutable memtable. Only the writes
+  // with a sequence number <= sequence are seen.
+  std::unique_ptr<Iterator>
+  new_scan_iterator(uint64_t sequence = MemTableStorage::MAX_SEQUENCE);
 
   SST flush(SSTConfig &sst_config);
   uint64_t get_id();
 
 private:
   std::shared_ptr<MemTableStorage> storage_;
-  std::shared_mutex shared_mu_;
-  std::uint64_t approximate_size_;
   std::uint64_t cap_size_;
-  Status status_;
+  std::atomic<Status> status_;
+  std::chrono::steady_clock::time_point frozen_at_;
   uint64_t id_;
 };
 
-// support immutable/freezed memtable iterator only.
+// iterates the skiplist in key order. Nodes are never unlinked, so the
+// iterator stays valid while a mutable memtable is being written. Keys with no
+// value at or below sequence are skipped.
 class ImmutableMemTableIterator : public Iterator {
 public:
-  ImmutableMemTableIterator(std::shared_ptr<MemTableStorage> storage);
+  ImmutableMemTableIterator(
+      std::shared_ptr<MemTableStorage> storage,
+      uint64_t sequence = MemTableStorage::MAX_SEQUENCE);
   bool is_valid();
 
-  // return the latest valid key
-  std::vector<std::byte> key();
-
-  // return the latest valid value
-  std::vector<std::byte> value();
+  // views into the skiplist arena, they outlive the iterator's position since
+  // nodes and replaced values are never freed before the memtable
+  std::span<const std::byte> key_view();
+  std::span<const std::byte> value_view();
 
   void next();
+  void seek(const std::vector<std::byte> &target);
 
   ~ImmutableMemTableIterator() = default;
 
+private:
+  // moves curr_node_ forward to the first node visible at sequence_
+  void skip_invisible();
+
 private:
   std::shared_ptr<MemTableStorage> storage_;
-  MemTableStorage::iterator curr_it_;
+  uint64_t sequence_;
+  const MemTableStorage::Node *curr_node_;
+  const MemTableStorage::Value *curr_value_;
 };
@@ -0,0 +1,43 @@
+#pragma once
+#include "iterator.hpp"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief k-way merge of sorted iterators through a min-heap.
+ *
+ * Children are given newest first. When several children hold the same key,
+ * only the entry of the newest child is returned, the older ones are skipped.
+ * Tombstones (empty values) are returned like any other entry.
+ */
+class MergeIterator : public Iterator {
+public:
+  MergeIterator(std::vector<std::unique_ptr<Iterator>> children);
+  void next() override;
+  void seek(const std::vector<std::byte> &target) override;
+  std::span<const std::byte> key_view() override;
+  std::span<const std::byte> value_view() override;
+  bool is_valid() override;
+
+private:
+  struct HeapEntry {
+    // view into the child, valid while the child sits in the heap
+    std::span<const std::byte> key_;
+    // position in children_, lower is newer
+    size_t child_idx_;
+  };
+  // heap order, the smallest key and then the newest child comes first
+  struct Greater {
+    bool operator()(const HeapEntry &lhs, const HeapEntry &rhs) const;
+  };
+
+private:
+  void build_heap();
+  void push_child(size_t child_idx);
+
+private:
+  std::vector<std::unique_ptr<Iterator>> children_;
+  std::vector<HeapEntry> heap_;
+  // copy of the key being skipped over by next(), kept to reuse its buffer
+  std::vector<std::byte> skip_key_;
+};
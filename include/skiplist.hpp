@@ -0,0 +1,118 @@
+#pragma once
+
+#include "arena.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Concurrent skiplist backing the memtable.
+ *
+ * Readers never block: links are published with release stores and followed
+ * with acquire loads. Writers insert concurrently by CAS-ing the predecessor
+ * link at each level; a writer that loses the race re-searches that level
+ * starting from its last predecessor. Nodes are never unlinked, so a node
+ * pointer handed out by seek()/first() stays valid while the skiplist lives.
+ *
+ * Nodes, keys and values live in the skiplist's arena. Overwriting a key swaps
+ * the node's value pointer, the previous value stays in the arena because a
+ * concurrent reader may still be copying it. Every value links to the one it
+ * replaced, so a reader can ask for the newest value written at or below a
+ * sequence number and skip the writes that are not published yet.
+ */
+class SkipList {
+public:
+  static const int MAX_HEIGHT = 12;
+  static const uint32_t BRANCHING = 4;
+  // reads at this sequence see every write
+  static const uint64_t MAX_SEQUENCE = UINT64_MAX;
+
+  struct Value {
+    size_t size_;
+    uint64_t sequence_;
+    // the value this one replaced, nullptr for the first value of a key
+    const Value *prev_;
+
+    std::span<const std::byte> data() const {
+      return {reinterpret_cast<const std::byte *>(this + 1), size_};
+    }
+  };
+
+  struct Node {
+    const std::byte *key_data_;
+    size_t key_size_;
+    std::atomic<const Value *> value_;
+    int height_;
+
+    std::span<const std::byte> key() const { return {key_data_, key_size_}; }
+    std::span<const std::byte> value() const {
+      return value_.load(std::memory_order_acquire)->data();
+    }
+    // newest value with sequence_ <= sequence, nullptr if there is none
+    const Value *value_at(uint64_t sequence) const {
+      const Value *value = value_.load(std::memory_order_acquire);
+      while (value != nullptr && value->sequence_ > sequence) {
+        value = value->prev_;
+      }
+      return value;
+    }
+
+    Node *next(int level) const {
+      return next_[level].load(std::memory_order_acquire);
+    }
+    void set_next_relaxed(int level, Node *node) {
+      next_[level].store(node, std::memory_order_relaxed);
+    }
+    bool cas_next(int level, Node *expected, Node *node) {
+      return next_[level].compare_exchange_strong(expected, node,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed);
+    }
+
+    // over-allocated to height_ entries, see SkipList::new_node
+    std::atomic<Node *> next_[1];
+  };
+
+  // size in bytes of the value replaced by an insert, or nullopt if the key
+  // was new.
+  using InsertResult = std::optional<size_t>;
+
+public:
+  explicit SkipList(size_t arena_chunk_size = Arena::DEFAULT_CHUNK_SIZE);
+  SkipList(const SkipList &) = delete;
+  SkipList &operator=(const SkipList &) = delete;
+
+  InsertResult insert(std::span<const std::byte> key,
+                      std::span<const std::byte> value, uint64_t sequence = 0);
+  std::optional<std::vector<std::byte>>
+  get(std::span<const std::byte> key,
+      uint64_t sequence = MAX_SEQUENCE) const;
+
+  // first node with key >= target, nullptr if none
+  const Node *seek(std::span<const std::byte> target) const;
+  const Node *first() const;
+  uint64_t count() const;
+  size_t memory_usage() const;
+
+private:
+  static int random_height();
+
+  Node *new_node(std::span<const std::byte> key, const Value *value,
+                 int height);
+  Value *new_value(std::span<const std::byte> value, uint64_t sequence);
+
+  // fills prev/next for every level such that prev[i]->key < key <= next[i]
+  void find_splice(std::span<const std::byte> key, Node **prev,
+                   Node **next) const;
+  void find_splice_for_level(std::span<const std::byte> key, Node *before,
+                             int level, Node **prev, Node **next) const;
+  size_t replace_value(Node *node, Value *value);
+
+private:
+  Arena arena_;
+  Node *head_;
+  std::atomic<uint64_t> count_;
+};
@@ -1,40 +1,86 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <span>
 #include <vector>
 
+/**
+ * @brief A data block, kept in its encoded form.
+ *
+ * The block pins the buffer it was read into, or the mapping it views, and
+ * decodes entries from it on demand, so iterators can hand out views into
+ * the buffer for as long as they hold the block.
+ */
 class Block {
 public:
   struct Entry {
     std::vector<std::byte> key_;
     std::vector<std::byte> value_;
   };
+  static const size_t EntrySharedLenSize = 2;
   static const size_t EntryKeyLenSize = 2;
   static const size_t EntryValueLenSize = 2;
+  static const size_t EntryHeaderSize =
+      EntrySharedLenSize + EntryKeyLenSize + EntryValueLenSize;
+  static const size_t RestartIntervalSize = 2;
   static const size_t FooterLenSize = 2;
   static const size_t OffsetSize = 2;
 
-  Block(std::vector<std::byte> data, std::vector<uint16_t> offset)
-      : data_(std::move(data)), offsets_(std::move(offset)) {}
+  Block() : data_size_(0), restart_interval_(1), n_entries_(0) {}
 
   /**
    * @brief The encoded format is
-   * data_ | offsets_ | number_of_entries (2byte)
-   * Decode read the number_of_entries at the end of the data, and subsequent
-   * read the offsets_ value. Each element in offsets_ value is 2 bytes.
-   * @return std::vector<std::byte>
+   * data | restarts | restart_interval (2byte) | number_of_entries (2byte)
+   *
+   * Each entry of data is
+   * shared_key_len (2byte) | unshared_key_len (2byte) | value_len (2byte) |
+   * unshared key bytes | value
+   * where the key shares its first shared_key_len bytes with the previous
+   * entry's key. Every restart_interval-th entry is a restart point: it
+   * stores its full key (shared_key_len = 0) and its offset is listed in
+   * restarts, 2 bytes each. Lookups binary search the restart points and
+   * then scan at most restart_interval entries.
    */
   std::vector<std::byte> encode();
-  static Block decode(const std::vector<std::byte> &bytes);
+  // takes ownership of the buffer, moving it in avoids any copy
+  static Block decode(std::vector<std::byte> bytes);
+  // views bytes without copying them, pin keeps their memory alive
+  static Block decode(std::span<const std::byte> bytes,
+                      std::shared_ptr<const void> pin);
   Entry get_entry(size_t entry_idx);
+  // decodes the entry at offset. key holds the previous entry's key and is
+  // rebuilt in place, value is set to a view into the block. Returns the
+  // offset of the next entry. Meant for sequential iteration, offsets come
+  // from restart_offset() or a previous call.
+  size_t decode_entry(size_t offset, std::vector<std::byte> &key,
+                      std::span<const std::byte> &value) const;
+  // offset of the restart entry covering entry_idx
+  size_t restart_offset(size_t entry_idx) const;
   size_t size();
-  std::optional<std::vector<std::byte>> get(const std::vector<std::byte> &key);
+  // bytes held by the decoded block, used as its block cache charge
+  size_t memory_usage() const;
+  std::optional<std::vector<std::byte>> get(std::span<const std::byte> key);
+  // index of the restart entry to scan from to find the first entry with a
+  // key >= target. The entries must be sorted.
+  size_t seek_restart(std::span<const std::byte> target);
 
   std::vector<std::byte> get_first_key();
   std::vector<std::byte> get_last_key();
 
 private:
-  std::vector<std::byte> data_;
-  std::vector<uint16_t> offsets_;
+  Block(std::span<const std::byte> buffer, std::shared_ptr<const void> pin,
+        size_t data_size, uint16_t restart_interval, uint16_t n_entries)
+      : pin_(std::move(pin)), buffer_(buffer), data_size_(data_size),
+        restart_interval_(restart_interval), n_entries_(n_entries) {}
+
+private:
+  // owner of the memory buffer_ points into
+  std::shared_ptr<const void> pin_;
+  // the whole encoded block, the restarts start at data_size_
+  std::span<const std::byte> buffer_;
+  size_t data_size_;
+  uint16_t restart_interval_;
+  uint16_t n_entries_;
 };
@@ -1,16 +1,24 @@
 #pragma once
+#include <cstdint>
+#include <span>
 #include <vector>
 
 class Block;
 class BlockBuilder {
 public:
-  BlockBuilder() : size_(0) {}
-  void add_entry(std::vector<std::byte> &key, std::vector<std::byte> &value);
+  static const uint16_t DEFAULT_RESTART_INTERVAL = 16;
+
+  BlockBuilder(uint16_t restart_interval = DEFAULT_RESTART_INTERVAL);
+  void add_entry(std::span<const std::byte> key,
+                 std::span<const std::byte> value);
   Block build();
-  size_t get_size();
+  // encoded size of the entries and their restart points so far
+  size_t get_size() const;
 
 private:
   std::vector<std::byte> data_;
-  std::vector<std::uint16_t> offsets_;
-  size_t size_;
+  std::vector<std::uint16_t> restarts_;
+  std::vector<std::byte> last_key_;
+  uint16_t restart_interval_;
+  uint16_t n_entries_;
 };
@@ -0,0 +1,26 @@
+#pragma once
+#include "lru_cache.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+class Block;
+
+// identifies a block by its SST and its offset in the SST file
+struct BlockCacheKey {
+  uint64_t sst_id_;
+  uint64_t offset_;
+
+  bool operator==(const BlockCacheKey &) const = default;
+};
+
+struct BlockCacheKeyHash {
+  size_t operator()(const BlockCacheKey &key) const {
+    uint64_t h = key.sst_id_ * 0x9E3779B97F4A7C15ULL;
+    return std::hash<uint64_t>{}(h ^ key.offset_);
+  }
+};
+
+// decoded SST blocks shared by every SST of a Storage, charged by their size
+using BlockCache =
+    ShardedLRUCache<BlockCacheKey, std::shared_ptr<Block>, BlockCacheKeyHash>;
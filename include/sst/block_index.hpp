@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * @brief In-memory index of the data blocks of one SST.
+ *
+ * The first and last key of every block are packed back to back in a single
+ * buffer, key_offsets_[2 * i] and key_offsets_[2 * i + 1] locate the keys of
+ * block i. Lookups binary search the last keys, so a lookup costs
+ * O(log n_blocks) comparisons over two contiguous arrays instead of one heap
+ * allocation per key.
+ */
+class BlockIndex {
+public:
+  void add(uint64_t offset, uint64_t size, std::span<const std::byte> first_key,
+           std::span<const std::byte> last_key);
+  // releases the spare capacity once every block is added
+  void shrink_to_fit();
+
+  size_t size() const;
+  uint64_t offset(size_t block_idx) const;
+  uint64_t block_size(size_t block_idx) const;
+  std::span<const std::byte> first_key(size_t block_idx) const;
+  std::span<const std::byte> last_key(size_t block_idx) const;
+
+  // first block whose last key is >= key, size() if none
+  size_t lower_bound(std::span<const std::byte> key) const;
+  // the only block that can hold key, nullopt if key is outside every block
+  std::optional<size_t> find(std::span<const std::byte> key) const;
+
+  size_t memory_usage() const;
+
+private:
+  std::span<const std::byte> key_at(size_t key_idx) const;
+
+private:
+  struct BlockHandle {
+    uint64_t offset_;
+    uint64_t size_;
+  };
+
+private:
+  std::vector<std::byte> keys_;
+  // start of every key in keys_, plus the end of the last one
+  std::vector<uint32_t> key_offsets_{0};
+  std::vector<BlockHandle> handles_;
+};
@@ -1,25 +1,26 @@
 #pragma once
 
 #include "iterator.hpp"
+#include "sst/block.hpp"
 #include <memory>
 
-class Block;
+// iterates a block without copying its entries. The values are views into
+// the block buffer, which the iterator pins, and keys are rebuilt in a
+// buffer reused across entries.
 class BlockIterator : public Iterator {
 public:
   BlockIterator(std::shared_ptr<Block> block);
   void next() override;
-  std::vector<std::byte> key() override;
-  std::vector<std::byte> value() override;
+  void seek(const std::vector<std::byte> &target) override;
+  std::span<const std::byte> key_view() override;
+  std::span<const std::byte> value_view() override;
   bool is_valid() override;
 
-private:
-  struct Record {
-    std::vector<std::byte> key_;
-    std::vector<std::byte> value_;
-  };
-
 private:
   std::shared_ptr<Block> block_ptr_;
-  Record curr_record_;
+  std::vector<std::byte> curr_key_;
+  std::span<const std::byte> curr_value_;
   uint64_t curr_offsets_idx_;
+  // offset of the entry after the current one in the block data
+  size_t next_offset_;
 };
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Bloom filter over the keys of one SST.
+ *
+ * Encoded format:
+ * bits | n_probes (1 byte)
+ *
+ * Probes are derived from a single 32-bit hash of the key with double
+ * hashing, so the builder only keeps one hash per key. An empty filter
+ * matches every key, it is what an SST built with bits_per_key = 0 stores.
+ */
+class BloomFilter {
+public:
+  static uint32_t hash(std::span<const std::byte> key);
+  static std::vector<std::byte> build(const std::vector<uint32_t> &key_hashes,
+                                      size_t bits_per_key);
+
+public:
+  BloomFilter() = default;
+  explicit BloomFilter(std::vector<std::byte> data);
+
+  // false means the key is definitely not in the SST
+  bool may_contain(std::span<const std::byte> key) const;
+  size_t size() const;
+
+private:
+  static constexpr size_t MIN_BITS = 64;
+  static constexpr uint8_t MAX_PROBES = 30;
+
+private:
+  std::vector<std::byte> data_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "iterator.hpp"
+#include "sst/sst_iterator.hpp"
+#include "sst/table_cache.hpp"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Concatenation of the SSTs of one sorted level.
+ *
+ * The files are sorted by key and never overlap, so only one of them is read
+ * at a time. A file is opened through the TableCache once the iterator
+ * reaches it and released when the iterator moves past it, a scan keeps one
+ * open SST per level instead of every SST it covers. Holding the handles
+ * keeps the files from being deleted as obsolete.
+ *
+ * The iterator is not positioned until seek() is called.
+ */
+class LevelIterator : public Iterator {
+public:
+  LevelIterator(std::shared_ptr<TableCache> table_cache,
+                std::vector<std::shared_ptr<const SSTHandle>> files);
+  LevelIterator(const LevelIterator &) = delete;
+  LevelIterator &operator=(const LevelIterator &) = delete;
+
+  void next() override;
+  void seek(const std::vector<std::byte> &target) override;
+  std::span<const std::byte> key_view() override;
+  std::span<const std::byte> value_view() override;
+  bool is_valid() override;
+
+private:
+  // opens files_[file_idx_], or releases the current file past the last one
+  void open_file();
+  // moves to the first entry of the following files while the current one
+  // is exhausted
+  void skip_exhausted_files();
+
+private:
+  std::shared_ptr<TableCache> table_cache_;
+  std::vector<std::shared_ptr<const SSTHandle>> files_;
+  size_t file_idx_;
+  std::unique_ptr<SSTIterator> file_iterator_;
+};
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "io/file_reader.hpp"
+#include "io/mmap_file.hpp"
+#include "sst/block_cache.hpp"
+#include "sst/block_index.hpp"
+#include "sst/bloom_filter.hpp"
 #include <filesystem>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -13,17 +19,36 @@ class BlockBuilder;
 
 /**
  * @brief SST encoded format
- * block | ... | block | block_metadata | ... | block_metadata |
+ * block | ... | block | filter | block_metadata | ... | block_metadata |
  * block_metadata_offset (u64) | ... | block_metadata_offset (u64) |
- * n_block (u64)
+ * filter_offset (u64) | filter_size (u64) | n_block (u64)
+ *
+ * filter is the BloomFilter of every key in the SST, filter_size is 0 when
+ * the SST was built without a filter.
  *
  * block_metadata encoded format:
  *  block_offset (8 bytes) | block_size (8 bytes) | first_key_len (2 bytes) |
  * first_key | last_key_len (2 bytes) | last_key
  *
- * constructor will read the block_metadata into the memory.
- * block is accessed on demand from disk to avoid OOM.
+ * constructor will read the block_metadata into a packed BlockIndex and the
+ * filter into the memory.
+ * block is accessed on demand from disk to avoid OOM, and kept in the block
+ * cache when the SST has one.
  */
+// how an SST reads its file
+enum class SSTReadMode {
+  // blocks are read into buffers with pread and cached in the block cache
+  PREAD,
+  // like PREAD, but batched block reads (get_blocks) are submitted together
+  // through io_uring: SST::multi_get and the SSTIterator readahead. A point
+  // get() still reads its single block with pread. Falls back to PREAD when
+  // io_uring is unavailable.
+  IO_URING,
+  // the whole file is mapped, blocks are views into the mapping and bypass
+  // the block cache. Meant for datasets that fit in memory.
+  MMAP,
+};
+
 class BlockMetadata {
 public:
   uint64_t offset_;
@@ -42,27 +67,64 @@ public:
 
 class SST {
 public:
-  SST(const std::filesystem::path &file_name);
+  SST(const std::filesystem::path &file_name,
+      std::shared_ptr<BlockCache> block_cache = nullptr,
+      SSTReadMode read_mode = SSTReadMode::PREAD);
   std::optional<std::vector<std::byte>> get(std::vector<std::byte> &key);
+  // Looks up many keys at once, the keys should be sorted. Keys of the same
+  // block share one read, and the blocks are fetched with get_blocks. An
+  // empty value is a tombstone, as with get().
+  std::vector<std::optional<std::vector<std::byte>>>
+  multi_get(std::span<const std::span<const std::byte>> keys) const;
+  // false when the filter rules the key out, get() then reads no block
+  bool may_contain(const std::vector<std::byte> &key) const;
 
-  const std::vector<BlockMetadata> &get_block_metadata() const;
-  Block get_block(size_t block_idx) const;
+  // materialized from the index, meant for tests and debugging
+  std::vector<BlockMetadata> get_block_metadata() const;
+  const BlockIndex &get_index() const;
+  std::shared_ptr<Block> get_block(size_t block_idx) const;
+  // the blocks missing from the block cache are fetched with one batched
+  // read, adjacent blocks in a single syscall
+  std::vector<std::shared_ptr<Block>>
+  get_blocks(std::span<const size_t> block_idxs) const;
   size_t number_of_block() const;
   uint64_t get_id() const;
+  // key range of the SST, empty when it has no entries
+  std::vector<std::byte> smallest_key() const;
+  std::vector<std::byte> largest_key() const;
+  uint64_t file_size() const;
+  SSTReadMode get_read_mode() const;
+  // hints that blocks are about to be read in order, e.g. by an SSTIterator.
+  // Every begin_sequential_read must be paired with an end_sequential_read.
+  void begin_sequential_read() const;
+  void end_sequential_read() const;
 
 private:
   static const uint32_t NUMBER_OF_BLOCK_VAL_SIZE = 8;
   static const uint32_t BLOCK_METADATA_OFFSET_VAL_SIZE = 8;
+  static const uint32_t FILTER_OFFSET_VAL_SIZE = 8;
+  static const uint32_t FILTER_SIZE_VAL_SIZE = 8;
 
 private:
   void read_block_metadata();
-  Block read_block(const BlockMetadata &) const;
+  std::shared_ptr<Block> read_block(size_t block_idx) const;
+  std::shared_ptr<Block> lookup_cached_block(size_t block_idx) const;
+  std::shared_ptr<Block> insert_block(size_t block_idx,
+                                      std::vector<std::byte> buffer) const;
+  // reads length bytes at offset from the file or the mapping
+  void read_bytes(size_t offset, size_t length,
+                  std::vector<std::byte> &buffer) const;
   uint64_t decode_uint64(size_t offset);
-  std::vector<std::byte> decode_var_string(size_t offset);
   uint64_t parse_id_from_file_name(const std::filesystem::path &file_name);
 
 private:
-  std::vector<BlockMetadata> block_metadata_;
+  BlockIndex index_;
+  BloomFilter filter_;
+  // exactly one of io_ and mmap_ is set, depending on the read mode
   std::unique_ptr<FileReader> io_;
+  // shared with the blocks viewing the mapping
+  std::shared_ptr<MmapFile> mmap_;
+  std::shared_ptr<BlockCache> block_cache_;
   uint64_t id_;
+  SSTReadMode read_mode_;
 };
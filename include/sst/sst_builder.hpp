@@ -1,7 +1,10 @@
 #pragma once
 #include "sst/block_builder.hpp"
+#include "sst/block_cache.hpp"
+#include "sst/sst.hpp"
 #include <filesystem>
 #include <fstream>
+#include <memory>
 
 class SST;
 class BlockMetadata;
@@ -9,19 +12,32 @@ class BlockMetadata;
 struct SSTConfig {
   size_t block_size_;
   std::filesystem::path sst_directory_;
+  // bloom filter size, 0 builds no filter
+  size_t bloom_bits_per_key_{10};
+  // handed to the built SST, nullptr disables caching
+  std::shared_ptr<BlockCache> block_cache_;
+  // entries between two full keys in a data block
+  uint16_t restart_interval_{BlockBuilder::DEFAULT_RESTART_INTERVAL};
+  // how the built SST reads its file
+  SSTReadMode read_mode_{SSTReadMode::PREAD};
 };
 
 class SSTBuilder {
 public:
   SSTBuilder(const std::filesystem::path &path, SSTConfig &sst_config);
-  void add_entry(std::vector<std::byte> &key, std::vector<std::byte> &val);
+  void add_entry(std::span<const std::byte> key,
+                 std::span<const std::byte> val);
   SST build();
+  // bytes of the blocks written so far plus the block being built, the
+  // filter and the block metadata are not counted
+  uint64_t estimated_size() const;
 
   // for testing only
   const std::vector<BlockMetadata> &get_block_metadata() const;
 
 private:
   void write_block();
+  void write_filter();
 
 private:
   bool finished_;
@@ -29,5 +45,8 @@ private:
   std::ofstream out_;
   BlockBuilder block_builder_;
   std::vector<BlockMetadata> block_metadata_;
+  std::vector<uint32_t> key_hashes_;
+  uint64_t filter_offset_;
+  uint64_t filter_size_;
   std::filesystem::path path_;
 };
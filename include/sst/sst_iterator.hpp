@@ -2,27 +2,46 @@
 #include "block_iterator.hpp"
 #include "iterator.hpp"
 #include <memory>
+#include <optional>
+#include <vector>
 
 class SST;
 class BlockIterator;
 
 class SSTIterator : public Iterator {
 public:
+  // blocks fetched by one readahead, see load_block()
+  static const size_t READAHEAD_BLOCKS = 8;
+
+  // registers as a sequential reader of the SST for its whole lifetime
   SSTIterator(std::shared_ptr<SST> sst_ptr);
+  SSTIterator(const SSTIterator &) = delete;
+  SSTIterator &operator=(const SSTIterator &) = delete;
+  ~SSTIterator();
   void next();
-  std::vector<std::byte> key();
-  std::vector<std::byte> value();
+  void seek(const std::vector<std::byte> &target);
+  // views into the current block, which the iterator pins
+  std::span<const std::byte> key_view();
+  std::span<const std::byte> value_view();
   bool is_valid();
 
 private:
-  struct Entry {
-    std::vector<std::byte> key_;
-    std::vector<std::byte> val_;
-  };
+  // loads block_idx_, or an empty block past the last one. Under
+  // SSTReadMode::IO_URING, loading the block right after the previous one
+  // reads it and the following READAHEAD_BLOCKS - 1 blocks with one
+  // get_blocks call, later loads are served from that batch.
+  std::shared_ptr<Block> load_block();
+  // moves to the first entry at or after the current position, skipping
+  // empty blocks
+  void skip_empty_blocks();
 
 private:
   std::shared_ptr<SST> sst_ptr_;
-  BlockIterator curr_block_iterator_;
   size_t block_idx_;
-  Entry curr_entry;
+  // the block loaded before block_idx_, a seek does not start a readahead
+  std::optional<size_t> prev_block_idx_;
+  // blocks [readahead_idx_, readahead_idx_ + readahead_.size())
+  std::vector<std::shared_ptr<Block>> readahead_;
+  size_t readahead_idx_;
+  BlockIterator curr_block_iterator_;
 };
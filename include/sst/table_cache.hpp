@@ -0,0 +1,64 @@
+#pragma once
+#include "lru_cache.hpp"
+#include "sst/block_cache.hpp"
+#include "sst/sst.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+// What Storage keeps in memory per SST. The SST itself, with its open file,
+// index and filter, is opened on demand through the TableCache.
+struct SSTHandle {
+  uint64_t id_;
+  std::vector<std::byte> smallest_key_;
+  std::vector<std::byte> largest_key_;
+  uint64_t file_size_;
+
+  static SSTHandle from_sst(const SST &sst);
+  // false when key is outside [smallest_key_, largest_key_]
+  bool may_contain(std::span<const std::byte> key) const;
+  // whether the SST key range intersects [lower, upper), an empty upper
+  // means no upper bound
+  bool overlaps(std::span<const std::byte> lower,
+                std::span<const std::byte> upper) const;
+};
+
+/**
+ * @brief Bounded set of open SSTs, evicted in LRU order.
+ *
+ * Opening an SST costs a file descriptor plus its index and filter, the
+ * cache keeps at most capacity of them open (a capacity of 0 caches none).
+ * Evicted SSTs stay usable by whoever still holds them and close their file
+ * once the last holder drops them.
+ */
+class TableCache {
+public:
+  TableCache(std::filesystem::path sst_directory, size_t capacity,
+             std::shared_ptr<BlockCache> block_cache, SSTReadMode read_mode);
+  TableCache(const TableCache &) = delete;
+  TableCache &operator=(const TableCache &) = delete;
+
+  // opens the SST on a miss
+  std::shared_ptr<SST> get(uint64_t sst_id);
+  // opens the SST bypassing both this cache and the block cache, for readers
+  // such as compactions that go through the SST once
+  std::shared_ptr<SST> open_uncached(uint64_t sst_id) const;
+  // caches an SST that is already open, e.g. one that was just built
+  void insert(std::shared_ptr<SST> sst);
+  // drops the SST from the cache, e.g. once its file is obsolete
+  void evict(uint64_t sst_id);
+  std::filesystem::path sst_path(uint64_t sst_id) const;
+  // number of SSTs kept open by the cache
+  size_t size();
+  uint64_t hits() const;
+  uint64_t misses() const;
+
+private:
+  std::filesystem::path sst_directory_;
+  std::shared_ptr<BlockCache> block_cache_;
+  SSTReadMode read_mode_;
+  // every SST is charged 1, capacity is a number of SSTs
+  ShardedLRUCache<uint64_t, std::shared_ptr<SST>> cache_;
+};
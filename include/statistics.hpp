@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// point-in-time copy of the Storage counters, see Storage::get_stats
+struct StorageStats {
+  uint64_t flush_count_{0};
+  // bytes of the SSTs written by the flushes
+  uint64_t flush_bytes_written_{0};
+  // time between a memtable being frozen and the start of its flush
+  std::chrono::microseconds flush_lag_total_{0};
+  std::chrono::microseconds flush_lag_max_{0};
+  // write groups slowed down past a soft limit, and the time they slept
+  uint64_t write_delay_count_{0};
+  std::chrono::microseconds write_delay_total_{0};
+  // write groups blocked at a hard limit, and the time they waited
+  uint64_t write_stop_count_{0};
+  std::chrono::microseconds write_stop_total_{0};
+  uint64_t block_cache_hit_count_{0};
+  uint64_t block_cache_miss_count_{0};
+  // lookups of open SSTs, a miss opens the SST file
+  uint64_t table_cache_hit_count_{0};
+  uint64_t table_cache_miss_count_{0};
+  // compactions that rewrote SSTs, and the SST bytes they read and wrote
+  uint64_t compaction_count_{0};
+  uint64_t compaction_bytes_read_{0};
+  uint64_t compaction_bytes_written_{0};
+  // number of SSTs in every level
+  std::vector<uint64_t> level_file_count_;
+};
+
+// Counters updated concurrently by the foreground and background threads.
+class Statistics {
+public:
+  void record_flush(std::chrono::microseconds lag);
+  void record_flush_write(uint64_t bytes_written);
+  void record_write_delay(std::chrono::microseconds delay);
+  void record_write_stop(std::chrono::microseconds duration);
+  void record_compaction(uint64_t bytes_read, uint64_t bytes_written);
+  StorageStats snapshot() const;
+
+private:
+  static void update_max(std::atomic<uint64_t> &max, uint64_t val);
+
+private:
+  std::atomic<uint64_t> flush_count_{0};
+  std::atomic<uint64_t> flush_bytes_written_{0};
+  std::atomic<uint64_t> flush_lag_total_us_{0};
+  std::atomic<uint64_t> flush_lag_max_us_{0};
+  std::atomic<uint64_t> write_delay_count_{0};
+  std::atomic<uint64_t> write_delay_total_us_{0};
+  std::atomic<uint64_t> write_stop_count_{0};
+  std::atomic<uint64_t> write_stop_total_us_{0};
+  std::atomic<uint64_t> compaction_count_{0};
+  std::atomic<uint64_t> compaction_bytes_read_{0};
+  std::atomic<uint64_t> compaction_bytes_written_{0};
+};
@@ -1,27 +1,95 @@
 #pragma once
+#include "compaction/compaction.hpp"
 #include "manifest/manifest.hpp"
 #include "memtable.hpp"
 #include "sst/sst.hpp"
+#include "sst/table_cache.hpp"
+#include "statistics.hpp"
+#include "storage_iterator.hpp"
+#include "thread_pool.hpp"
 #include "wal/wal.hpp"
+#include "write_batch.hpp"
+#include "write_controller.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <span>
 #include <thread>
 #include <vector>
 
-enum class WALSyncOption {
-  SYNC_ON_CLOSE,
-  SYNC_ON_WRITE,
-};
-
 struct StorageOption {
   std::uint64_t mem_table_size_{4096};
   std::uint64_t max_number_of_memtable_{2};
   std::uint64_t max_sst_block_size_{1024};
+  // bloom filter bits per key of the flushed SSTs, 0 disables the filter
+  std::uint64_t bloom_bits_per_key_{10};
+  // data block entries between two full, uncompressed keys
+  std::uint16_t block_restart_interval_{16};
+  // capacity in bytes of the decoded block cache shared by every SST, 0
+  // disables the cache
+  std::uint64_t block_cache_size_{8 << 20};
+  // MMAP maps every SST and serves blocks from the mapping, without the block
+  // cache. Fits datasets that stay resident in memory. IO_URING submits
+  // batched block reads together, for devices that need queue depth.
+  SSTReadMode sst_read_mode_{SSTReadMode::PREAD};
+  // number of SSTs kept open, with their file descriptor, index and filter.
+  // The others are reopened on demand.
+  std::uint64_t table_cache_capacity_{1000};
+  // LEVELED bounds read and space amplification, TIERED writes less for more
+  // sorted runs to read and more space. See CompactionOptions.
+  CompactionStyle compaction_style_{CompactionStyle::LEVELED};
+  // Leveled compaction, see LeveledCompactionPicker. Level 0 is compacted
+  // once it holds level0_file_num_compaction_trigger_ SSTs, level n > 0 once
+  // it outgrows max_bytes_for_level_base_ *
+  // max_bytes_for_level_multiplier_^(n-1) bytes.
+  std::uint64_t num_levels_{7};
+  std::uint64_t level0_file_num_compaction_trigger_{4};
+  std::uint64_t max_bytes_for_level_base_{256 * 1024};
+  std::uint64_t max_bytes_for_level_multiplier_{10};
+  // Tiered compaction, see TieredCompactionPicker. Starts once there are
+  // level0_file_num_compaction_trigger_ sorted runs.
+  std::uint64_t max_size_amplification_percent_{200};
+  std::uint64_t size_ratio_{1};
+  std::uint64_t min_merge_width_{2};
+  // compaction outputs are split into SSTs of about this size
+  std::uint64_t target_file_size_{64 * 1024};
+  // a compaction is split into up to this many key ranges, merged in
+  // parallel. 1 merges every compaction on the compaction thread.
+  std::uint64_t max_subcompactions_{1};
+  // number of memtables that are flushed to SST concurrently
+  std::uint64_t max_background_flushes{2};
   std::filesystem::path sst_directory_{"./sst"};
-  std::filesystem::path manifest_path_{"./manifest.json"};
+  // holds CURRENT and the manifest files
+  std::filesystem::path manifest_directory_{"./manifest"};
+  // the manifest is rewritten as a snapshot of the live SSTs and WALs once
+  // it grows past this many bytes
+  std::uint64_t max_manifest_file_size_{1 << 20};
   std::filesystem::path wal_directory_{"./wal"};
   WALSyncOption wal_sync_option{WALSyncOption::SYNC_ON_CLOSE};
+  // buffered WAL modes write to the file once this many bytes are pending
+  std::uint64_t wal_buffer_size_{64 * 1024};
+  // SYNC_PERIODIC: fsync the WAL at this interval, or earlier once
+  // wal_bytes_per_sync_ bytes were written since the last fsync
+  std::chrono::milliseconds wal_sync_interval_{10};
+  std::uint64_t wal_bytes_per_sync_{1 << 20};
+  // Write stall limits, 0 disables a limit. Writes are delayed past a soft
+  // limit and blocked at a hard limit until the flush catches up. The
+  // memtable soft limit should be above max_number_of_memtable_, which is
+  // the count the background flush keeps the immutable memtables at.
+  std::uint64_t immutable_memtable_soft_limit_{4};
+  std::uint64_t immutable_memtable_hard_limit_{8};
+  std::uint64_t pending_bytes_soft_limit_{0};
+  std::uint64_t pending_bytes_hard_limit_{0};
+  std::uint64_t l0_sst_soft_limit_{0};
+  std::uint64_t l0_sst_hard_limit_{0};
+  std::chrono::microseconds max_write_delay_{1000};
 };
 
 class SST;
@@ -33,30 +101,139 @@ public:
   void close();
   void put(std::vector<std::byte> &key, std::vector<std::byte> &value);
   std::optional<std::vector<std::byte>> get(std::vector<std::byte> &key);
+  // Looks up every key against one snapshot, values are in the order of the
+  // keys. Each table is searched once for all the keys still unresolved,
+  // and the keys falling in the same SST block share one block read.
+  std::vector<std::optional<std::vector<std::byte>>>
+  multi_get(std::span<const std::vector<std::byte>> keys);
   void remove(std::vector<std::byte> &key);
+  // iterates the live keys in [lower, upper) in key order, an empty upper
+  // means no upper bound
+  StorageIterator scan(const std::vector<std::byte> &lower,
+                       const std::vector<std::byte> &upper);
+  // applies every entry of the batch atomically, with one WAL record.
+  // Readers see either all of its entries or none of them.
+  void write(WriteBatch &batch);
 
   void flush_run(bool flush_all = false);
+  // runs compactions until no level needs one
+  void compact_run();
   uint64_t get_current_table_id();
+  StorageStats get_stats() const;
   ~Storage();
 
 private:
-  std::vector<std::byte> TOMBSTONE = std::vector<std::byte>();
-  std::vector<std::unique_ptr<SST>>
+  // A write waiting in the write queue. The writer at the front of the queue
+  // is the leader: it commits the batches of every queued writer with one WAL
+  // write (and one fsync with SYNC_ON_WRITE), then releases them.
+  struct Writer {
+    WriteBatch *batch_;
+    bool done_{false};
+    std::exception_ptr error_;
+    std::condition_variable cv_;
+  };
+  static const uint64_t MAX_WRITE_GROUP_SIZE = 1 << 20;
+
+  // Immutable snapshot of the tables a read has to search. Readers load the
+  // current one with a single atomic operation and search it without any
+  // lock, the tables stay alive until the last reader drops the snapshot.
+  struct SuperVersion {
+    std::shared_ptr<MemTable> active_memtable_;
+    // oldest first
+    std::vector<std::shared_ptr<MemTable>> immutable_memtable_;
+    // levels_[0] oldest first, see LevelFiles
+    std::vector<LevelFiles> levels_;
+  };
+
+private:
+  void write_group(std::vector<Writer *> &group, uint64_t group_size);
+  // delays or blocks the write group according to write_controller_
+  void throttle_write(std::unique_lock<std::shared_mutex> &lk);
+  WritePressure get_write_pressure() const;
+  void make_room_for_write(uint64_t write_size);
+  SSTConfig make_sst_config() const;
+  std::vector<std::shared_ptr<SST>>
   flush_to_SST(std::vector<std::shared_ptr<MemTable>> &mem_table_ptr);
+  // fsyncs new SSTs and their directory, before the manifest references them
+  void sync_ssts(const std::vector<std::shared_ptr<SST>> &tables) const;
   void flush_thread();
+  // wakes up the flush thread, flush_all also flushes the memtables that
+  // max_number_of_memtable_ would keep in memory
+  void schedule_flush(bool flush_all = false);
+  void compaction_thread();
+  void schedule_compaction();
+  void run_compaction(const Compaction &compaction);
+  // replaces the inputs of the compaction by its outputs in levels_ and the
+  // manifest
+  void install_compaction(const Compaction &compaction,
+                          std::vector<std::shared_ptr<SST>> &outputs);
+  // deletes the obsolete SSTs that no super version references anymore
+  void delete_obsolete_files();
   void recover(const std::vector<VersionEdit> &);
   void new_active_memtable();
+  // appends the edit to the manifest, rewritten as a snapshot once it is too
+  // large. Requires mu_, the edit must already be applied to the tables.
+  void write_manifest(const VersionEdit &version_edit);
+  std::filesystem::path wal_path(uint64_t wal_id) const;
+  // publishes the current tables to readers, requires mu_
+  void install_super_version();
 
 private:
   StorageOption opt_;
+  // mu_ protects the table lists below, every change to them is published
+  // to readers through super_version_
   std::vector<std::shared_ptr<MemTable>> immutable_memtable_;
-  std::vector<std::unique_ptr<SST>> sst_;
-  std::unique_ptr<MemTable> active_memtable_;
+  // one LevelFiles per level, the SSTs are opened through table_cache_
+  std::vector<LevelFiles> levels_;
+  // SSTs removed by a compaction, deleted once the readers dropped them
+  std::vector<std::pair<uint64_t, std::weak_ptr<const SSTHandle>>>
+      obsolete_sst_;
+  std::shared_ptr<MemTable> active_memtable_;
   std::unique_ptr<WAL> active_wal_;
   std::shared_mutex mu_;
+  std::atomic<std::shared_ptr<const SuperVersion>> super_version_;
+  WriteController write_controller_;
+  // signaled under mu_ when a flush shrinks immutable_memtable_
+  std::condition_variable_any stall_cv_;
+
+  // write_mu_ protects writers_. Writers check stopped_ under write_mu_
+  // before queueing, close() waits on writers_drained_cv_ for the queued ones.
+  std::mutex write_mu_;
+  std::deque<Writer *> writers_;
+  std::condition_variable writers_drained_cv_;
+  // sequence number of the last write group fully inserted into the active
+  // memtable. Readers only see the memtable entries at or below it.
+  std::atomic<uint64_t> last_sequence_{0};
 
   uint64_t latest_table_id_;
+  // every WAL below it is flushed, protected by mu_
+  uint64_t log_number_{0};
+  std::shared_ptr<BlockCache> block_cache_;
+  // shared with the scan iterators, which open their SSTs lazily
+  std::shared_ptr<TableCache> table_cache_;
   Manifest manifest_;
   std::atomic<bool> stopped_;
   std::thread flush_thread_;
+  std::unique_ptr<ThreadPool> flush_pool_;
+
+  // flush_run_mu_ serializes flushes
+  std::mutex flush_run_mu_;
+  // flush_mu_ protects flush_pending_ and flush_all_pending_
+  std::mutex flush_mu_;
+  std::condition_variable flush_cv_;
+  bool flush_pending_{false};
+  bool flush_all_pending_{false};
+
+  // compact_run_mu_ serializes compactions and protects compaction_picker_
+  std::mutex compact_run_mu_;
+  std::unique_ptr<CompactionPicker> compaction_picker_;
+  std::thread compaction_thread_;
+  // merges the key ranges of a split compaction, null without subcompactions
+  std::unique_ptr<ThreadPool> compaction_pool_;
+  // compaction_mu_ protects compaction_pending_
+  std::mutex compaction_mu_;
+  std::condition_variable compaction_cv_;
+  bool compaction_pending_{false};
+
+  Statistics stats_;
 };
@@ -0,0 +1,29 @@
+#pragma once
+#include "merge_iterator.hpp"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Iterator returned by Storage::scan.
+ *
+ * Walks the merged view of every memtable and SST in [lower, upper), skipping
+ * deleted keys. An empty upper bound means no upper bound. The iterator keeps
+ * the tables it reads alive, it is not affected by later flushes.
+ */
+class StorageIterator : public Iterator {
+public:
+  StorageIterator(std::unique_ptr<MergeIterator> iter,
+                  std::vector<std::byte> upper);
+  void next() override;
+  void seek(const std::vector<std::byte> &target) override;
+  std::span<const std::byte> key_view() override;
+  std::span<const std::byte> value_view() override;
+  bool is_valid() override;
+
+private:
+  void skip_tombstones();
+
+private:
+  std::unique_ptr<MergeIterator> iter_;
+  std::vector<std::byte> upper_;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of worker threads running tasks in FIFO order.
+ * The destructor drains the queued tasks before joining the workers.
+ */
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t n_threads);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ~ThreadPool();
+
+  template <typename F>
+  std::future<std::invoke_result_t<F>> submit(F &&task) {
+    std::packaged_task<std::invoke_result_t<F>()> packaged{
+        std::forward<F>(task)};
+    auto future = packaged.get_future();
+    {
+      std::lock_guard lk{mu_};
+      tasks_.emplace_back(std::move(packaged));
+    }
+    cv_.notify_one();
+    return future;
+  }
+
+  size_t size() const;
+
+private:
+  void worker();
+
+private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::move_only_function<void()>> tasks_;
+  bool stopped_{false};
+  std::vector<std::thread> workers_;
+};
@@ -1,6 +1,9 @@
 #pragma once
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <glob.h>
 #include <span>
@@ -18,6 +21,24 @@ inline uint16_t decode_uint16_t(std::span<const std::byte, 2> &tmp) {
   return static_cast<uint16_t>(high << 8 | low);
 }
 
+inline std::array<std::byte, 4> encode_uint32_t(uint32_t val) {
+  std::array<std::byte, 4> encoded_bytes;
+  for (int i = 3; i >= 0; i--) {
+    encoded_bytes[i] = std::byte(val & 0xFF);
+    val = val >> 8;
+  }
+  return encoded_bytes;
+}
+
+inline uint32_t decode_uint32_t(std::span<const std::byte, 4> byte_views) {
+  uint32_t decoded_val = 0;
+  for (auto &val : byte_views) {
+    decoded_val = (decoded_val << 8) |
+                  static_cast<uint32_t>(std::to_integer<uint8_t>(val));
+  }
+  return decoded_val;
+}
+
 inline std::array<std::byte, 8> encode_uint64_t(uint64_t val) {
   std::array<std::byte, 8> encoded_bytes;
   for (int i = 7; i >= 0; i--) {
@@ -36,6 +57,41 @@ inline uint64_t decode_uint64_t(std::span<const std::byte, 8> byte_views) {
   return decoded_val;
 }
 
+// CRC-32C (Castagnoli), used to detect torn or corrupted records on disk.
+inline uint32_t crc32c(std::span<const std::byte> data, uint32_t crc = 0) {
+  static const auto table = []() {
+    std::array<uint32_t, 256> tbl{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t val = i;
+      for (int bit = 0; bit < 8; bit++) {
+        val = (val & 1) ? (val >> 1) ^ 0x82F63B78 : val >> 1;
+      }
+      tbl[i] = val;
+    }
+    return tbl;
+  }();
+
+  crc = ~crc;
+  for (auto byte : data) {
+    crc = table[(crc ^ std::to_integer<uint8_t>(byte)) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// memcmp order, the same order as operator< on std::vector<std::byte>
+inline int compare_bytes(std::span<const std::byte> lhs,
+                         std::span<const std::byte> rhs) {
+  size_t len = std::min(lhs.size(), rhs.size());
+  int res = len == 0 ? 0 : std::memcmp(lhs.data(), rhs.data(), len);
+  if (res != 0) {
+    return res;
+  }
+  if (lhs.size() == rhs.size()) {
+    return 0;
+  }
+  return lhs.size() < rhs.size() ? -1 : 1;
+}
+
 inline std::vector<std::filesystem::path>
 glob_paths(const std::string &pattern) {
   glob_t g{};
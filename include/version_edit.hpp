@@ -1,7 +1,11 @@
-#include <nlohmann/json.hpp>
+#pragma once
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <set>
+#include <span>
 #include <tuple>
+#include <vector>
 
 struct DeletedFileMetadata {
   uint64_t level_;
@@ -10,11 +14,19 @@ struct DeletedFileMetadata {
   bool operator<(const DeletedFileMetadata &other) const {
     return std::tie(level_, file_id_) < std::tie(other.level_, other.file_id_);
   }
+
+  bool operator==(const DeletedFileMetadata &other) const {
+    return std::tie(level_, file_id_) == std::tie(other.level_, other.file_id_);
+  }
 };
 
 struct NewFileMetadata {
   uint64_t level_;
   uint64_t file_id_;
+  // key range and size of the SST
+  std::vector<std::byte> smallest_key_;
+  std::vector<std::byte> largest_key_;
+  uint64_t file_size_{0};
 
   bool operator<(const NewFileMetadata &other) const {
     return std::tie(level_, file_id_) < std::tie(other.level_, other.file_id_);
@@ -27,38 +39,59 @@ struct NewFileMetadata {
 
 struct WALAddition {
   uint64_t file_id_;
-};
-
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(NewFileMetadata, level_, file_id_);
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(WALAddition, file_id_);
 
-// Add these in a .cpp file or after struct definitions
-inline void to_json(nlohmann::json &j, const std::optional<WALAddition> &opt) {
-  if (opt)
-    j = *opt;
-  else
-    j = nullptr;
-}
-inline void from_json(const nlohmann::json &j,
-                      std::optional<WALAddition> &opt) {
-  if (j.is_null())
-    opt = std::nullopt;
-  else
-    opt = j.get<WALAddition>();
-}
+  bool operator==(const WALAddition &other) const {
+    return file_id_ == other.file_id_;
+  }
+};
 
+/**
+ * VersionEdit encoded format, a sequence of tagged fields:
+ *  NEW_FILE (1 byte) | level (8 bytes) | file_id (8 bytes) |
+ *   smallest_key_len (2 bytes) | smallest_key | largest_key_len (2 bytes) |
+ *   largest_key | file_size (8 bytes)
+ *  DELETED_FILE (1 byte) | level (8 bytes) | file_id (8 bytes)
+ *  WAL_ADDITION (1 byte) | file_id (8 bytes)
+ *  LOG_NUMBER (1 byte) | log_number (8 bytes)
+ */
 class VersionEdit {
 public:
-  void add_new_file(uint64_t level, uint64_t file_id);
+  void add_new_file(uint64_t level, uint64_t file_id,
+                    std::vector<std::byte> smallest_key = {},
+                    std::vector<std::byte> largest_key = {},
+                    uint64_t file_size = 0);
+  // a file removed by a compaction, applied before the new files of the
+  // same edit so that a file can move to another level
+  void delete_file(uint64_t level, uint64_t file_id);
   void add_new_wal(uint64_t wal_id);
+  // every WAL below log_number is flushed to SSTs, 0 leaves the watermark
+  // where it was
+  void set_log_number(uint64_t log_number);
   const std::set<NewFileMetadata> &get_new_file() const;
+  const std::set<DeletedFileMetadata> &get_deleted_file() const;
   const std::optional<WALAddition> &get_wal_addition() const;
+  uint64_t get_log_number() const;
+  std::vector<std::byte> encode() const;
+  // throws std::runtime_error on a truncated or unknown field
+  static VersionEdit decode(std::span<const std::byte> data);
   bool operator==(const VersionEdit &other) const {
-    return new_files_ == other.new_files_;
+    return new_files_ == other.new_files_ &&
+           deleted_files_ == other.deleted_files_ &&
+           wal_addition_ == other.wal_addition_ &&
+           log_number_ == other.log_number_;
   };
 
 public:
   std::set<NewFileMetadata> new_files_;
+  std::set<DeletedFileMetadata> deleted_files_;
   std::optional<WALAddition> wal_addition_;
+  uint64_t log_number_{0};
+
+private:
+  enum class Tag : uint8_t {
+    NEW_FILE = 1,
+    DELETED_FILE = 2,
+    WAL_ADDITION = 3,
+    LOG_NUMBER = 4,
+  };
 };
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(VersionEdit, new_files_, wal_addition_);
@@ -1,9 +1,32 @@
 
 #pragma once
 #include "io/file_writer.hpp"
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
+#include <mutex>
+#include <span>
+#include <thread>
 #include <vector>
 
+enum class WALSyncOption {
+  // frames are buffered and written in chunks, fsync happens on close
+  SYNC_ON_CLOSE,
+  // every write is followed by an fsync before it returns
+  SYNC_ON_WRITE,
+  // frames are buffered, a background thread writes and fsyncs them every
+  // sync_interval_ or once bytes_per_sync_ bytes are pending
+  SYNC_PERIODIC,
+};
+
+struct WALConfig {
+  WALSyncOption sync_option_{WALSyncOption::SYNC_ON_CLOSE};
+  // buffered frames are written to the file once this many bytes are pending
+  uint64_t buffer_size_{64 * 1024};
+  std::chrono::milliseconds sync_interval_{10};
+  uint64_t bytes_per_sync_{1 << 20};
+};
+
 struct WALRecord {
   std::vector<std::byte> key_;
   std::vector<std::byte> value_;
@@ -18,15 +41,57 @@ struct WALRecord {
 };
 
 class FileWriter;
+class WriteBatch;
+
+/**
+ * @brief WAL encoded format
+ * frame | ... | frame
+ *
+ * frame encoded format:
+ *  payload_len (4 bytes) | crc32c of payload (4 bytes) | payload
+ * payload is the encoded WALRecord of every entry of one WriteBatch.
+ *
+ * read_wal only returns the records of complete frames with a matching
+ * checksum, a frame torn by a crash is dropped as a whole so a batch is
+ * recovered all-or-nothing.
+ */
 class WAL {
 public:
-  WAL(const std::filesystem::path &);
+  static const uint32_t FRAME_LENGTH_ENCODED_SIZE = 4;
+  static const uint32_t FRAME_CHECKSUM_ENCODED_SIZE = 4;
+
+  WAL(const std::filesystem::path &, WALConfig config = {});
   void add_record_and_sync(const WALRecord &wal_record);
   void add_record(const WALRecord &wal_record);
+  void add_batch(const WriteBatch &batch);
+  // buffers every batch in its own frame
+  void add_batches(std::span<const WriteBatch *const> batches);
+  // writes every batch in its own frame with a single write and fsync
+  void add_batches_and_sync(std::span<const WriteBatch *const> batches);
+  // writes the buffered frames and fsyncs the file
+  void sync();
   static std::vector<WALRecord> read_wal(const std::filesystem::path &);
   ~WAL();
 
 private:
+  static void encode_frame(std::span<const WALRecord> records,
+                           std::vector<std::byte> &out);
+  // mu_ must be held
+  void maybe_write_buffer();
+  void write_buffer();
+  void sync_thread();
+
+private:
+  WALConfig config_;
   std::unique_ptr<FileWriter> writer_;
-  std::vector<WALRecord> records_;
+
+  // mu_ protects buffer_, unsynced_bytes_ and the writes to writer_. fsync
+  // runs outside of mu_ so it never blocks the foreground appends.
+  std::mutex mu_;
+  std::condition_variable sync_cv_;
+  // encoded frames that are not written to the file yet
+  std::vector<std::byte> buffer_;
+  uint64_t unsynced_bytes_{0};
+  bool stopped_{false};
+  std::thread sync_thread_;
 };
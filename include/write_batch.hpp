@@ -0,0 +1,28 @@
+#pragma once
+#include "wal/wal.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A group of puts and removes applied atomically by Storage::write.
+ * The whole batch is logged as a single framed WAL record, so recovery either
+ * replays every entry of the batch or none of them. Its memtable entries share
+ * a sequence number that readers only see once every entry is inserted.
+ */
+class WriteBatch {
+public:
+  void put(const std::vector<std::byte> &key,
+           const std::vector<std::byte> &value);
+  void remove(const std::vector<std::byte> &key);
+  void clear();
+
+  size_t count() const;
+  // sum of the key and value sizes of every entry
+  uint64_t byte_size() const;
+  const std::vector<WALRecord> &records() const;
+
+private:
+  std::vector<WALRecord> records_;
+  uint64_t byte_size_{0};
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// A limit set to 0 is disabled.
+struct WriteControllerConfig {
+  uint64_t immutable_memtable_soft_limit_{0};
+  uint64_t immutable_memtable_hard_limit_{0};
+  uint64_t pending_bytes_soft_limit_{0};
+  uint64_t pending_bytes_hard_limit_{0};
+  uint64_t l0_sst_soft_limit_{0};
+  uint64_t l0_sst_hard_limit_{0};
+  // delay of a write right below the hard limits
+  std::chrono::microseconds max_delay_{1000};
+};
+
+// amount of work waiting on the background flush when a write comes in
+struct WritePressure {
+  uint64_t immutable_memtables_{0};
+  // bytes held by the immutable memtables
+  uint64_t pending_bytes_{0};
+  uint64_t l0_ssts_{0};
+};
+
+enum class WriteStall { NONE, DELAYED, STOPPED };
+
+/**
+ * @brief Decides whether a write has to wait for the background flush.
+ *
+ * Past any soft limit a write is DELAYED. The delay grows linearly with how
+ * close the worst metric is to its hard limit, up to max_delay_. A write that
+ * reaches any hard limit is STOPPED until the flush brings every metric back
+ * under its hard limit.
+ */
+class WriteController {
+public:
+  explicit WriteController(WriteControllerConfig config = {});
+
+  WriteStall get_stall(const WritePressure &pressure) const;
+  // zero unless get_stall() returns DELAYED
+  std::chrono::microseconds get_delay(const WritePressure &pressure) const;
+
+private:
+  // > 1 at the hard limit, in (0, 1] past the soft limit, 0 otherwise
+  static double get_ratio(uint64_t val, uint64_t soft_limit,
+                          uint64_t hard_limit);
+  double get_max_ratio(const WritePressure &pressure) const;
+
+private:
+  WriteControllerConfig config_;
+};
@@ -0,0 +1,70 @@
+#include "arena.hpp"
+#include <algorithm>
+
+namespace {
+constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+size_t align_up(size_t bytes) {
+  return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+} // namespace
+
+Arena::Arena(size_t chunk_size)
+    : chunk_size_(align_up(chunk_size)), current_(nullptr), memory_usage_(0) {}
+
+std::byte *Arena::allocate(size_t bytes) {
+  bytes = align_up(bytes == 0 ? 1 : bytes);
+  if (bytes > chunk_size_ / 4) {
+    // keep the current chunk for the small allocations that follow
+    std::lock_guard lk{mu_};
+    memory_usage_.fetch_add(bytes, std::memory_order_relaxed);
+    return allocate_chunk(bytes)->data_.get();
+  }
+
+  while (true) {
+    Chunk *current = current_.load(std::memory_order_acquire);
+    if (current != nullptr) {
+      size_t offset =
+          current->used_.fetch_add(bytes, std::memory_order_relaxed);
+      if (offset + bytes <= current->size_) {
+        return current->data_.get() + offset;
+      }
+    }
+    if (std::byte *result = allocate_fallback(bytes, current)) {
+      return result;
+    }
+  }
+}
+
+size_t Arena::memory_usage() const {
+  size_t usage = memory_usage_.load(std::memory_order_relaxed);
+  Chunk *current = current_.load(std::memory_order_acquire);
+  if (current != nullptr) {
+    // a chunk whose tail is wasted counts as full until it is retired
+    usage += std::min(current->used_.load(std::memory_order_relaxed),
+                      current->size_);
+  }
+  return usage;
+}
+
+std::byte *Arena::allocate_fallback(size_t bytes, Chunk *current) {
+  std::lock_guard lk{mu_};
+  if (current_.load(std::memory_order_relaxed) != current) {
+    // another thread already installed a new chunk, retry the bump on it
+    return nullptr;
+  }
+
+  // the remaining tail of the retired chunk is wasted
+  Chunk *chunk = allocate_chunk(chunk_size_);
+  chunk->used_.store(bytes, std::memory_order_relaxed);
+  if (current != nullptr) {
+    memory_usage_.fetch_add(current->size_, std::memory_order_relaxed);
+  }
+  current_.store(chunk, std::memory_order_release);
+  return chunk->data_.get();
+}
+
+Arena::Chunk *Arena::allocate_chunk(size_t bytes) {
+  chunks_.push_back(std::make_unique<Chunk>(bytes));
+  return chunks_.back().get();
+}
@@ -0,0 +1,463 @@
+#include "compaction/compaction.hpp"
+#include "merge_iterator.hpp"
+#include "sst/sst_iterator.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <stdexcept>
+
+namespace {
+// an SST flushed from an empty memtable has no key range
+bool has_keys(const SSTHandle &handle) {
+  return !handle.smallest_key_.empty() || !handle.largest_key_.empty();
+}
+
+// whether the SST key range intersects [smallest, largest]
+bool overlaps(const SSTHandle &handle, std::span<const std::byte> smallest,
+              std::span<const std::byte> largest) {
+  return has_keys(handle) &&
+         compare_bytes(handle.largest_key_, smallest) >= 0 &&
+         compare_bytes(handle.smallest_key_, largest) <= 0;
+}
+
+// key range covered by files, false when none of them has keys
+bool key_range(const LevelFiles &files, std::vector<std::byte> &smallest,
+               std::vector<std::byte> &largest) {
+  bool found = false;
+  for (auto &file : files) {
+    if (!has_keys(*file)) {
+      continue;
+    }
+    if (!found || compare_bytes(file->smallest_key_, smallest) < 0) {
+      smallest = file->smallest_key_;
+    }
+    if (!found || compare_bytes(file->largest_key_, largest) > 0) {
+      largest = file->largest_key_;
+    }
+    found = true;
+  }
+  return found;
+}
+
+// output of a compaction is bottommost when no level below it overlaps the
+// key range of the inputs
+void set_bottommost(const std::vector<LevelFiles> &levels,
+                    Compaction &compaction) {
+  std::vector<std::byte> smallest;
+  std::vector<std::byte> largest;
+  if (!key_range(compaction.all_inputs(), smallest, largest)) {
+    // only empty SSTs, nothing to shadow
+    compaction.bottommost_ = true;
+    return;
+  }
+  compaction.bottommost_ = std::ranges::none_of(
+      levels.begin() + compaction.output_level_ + 1, levels.end(),
+      [&](const LevelFiles &level) {
+        return std::ranges::any_of(level, [&](auto &file) {
+          return overlaps(*file, smallest, largest);
+        });
+      });
+}
+} // namespace
+
+size_t find_file(const LevelFiles &level, std::span<const std::byte> key) {
+  auto it = std::ranges::lower_bound(
+      level, key,
+      [](std::span<const std::byte> lhs, std::span<const std::byte> rhs) {
+        return compare_bytes(lhs, rhs) < 0;
+      },
+      [](const std::shared_ptr<const SSTHandle> &file) {
+        return std::span<const std::byte>(file->largest_key_);
+      });
+  if (it == level.end() || compare_bytes(key, (*it)->smallest_key_) < 0) {
+    return level.size();
+  }
+  return it - level.begin();
+}
+
+bool Compaction::is_trivial_move() const {
+  return inputs_.size() == 1 && inputs_.front().files_.size() == 1 &&
+         inputs_.front().level_ != output_level_ &&
+         has_keys(*inputs_.front().files_.front());
+}
+
+LevelFiles Compaction::all_inputs() const {
+  LevelFiles files;
+  for (auto &input : inputs_) {
+    if (input.level_ == 0) {
+      files.insert(files.end(), input.files_.rbegin(), input.files_.rend());
+    } else {
+      files.insert(files.end(), input.files_.begin(), input.files_.end());
+    }
+  }
+  return files;
+}
+
+std::unique_ptr<CompactionPicker>
+CompactionPicker::create(CompactionOptions opt) {
+  switch (opt.style_) {
+  case CompactionStyle::LEVELED:
+    return std::make_unique<LeveledCompactionPicker>(std::move(opt));
+  case CompactionStyle::TIERED:
+    return std::make_unique<TieredCompactionPicker>(std::move(opt));
+  }
+  throw std::invalid_argument("unknown compaction style");
+}
+
+LeveledCompactionPicker::LeveledCompactionPicker(CompactionOptions opt)
+    : opt_(std::move(opt)), compact_pointer_(opt_.num_levels_) {}
+
+double LeveledCompactionPicker::score(const std::vector<LevelFiles> &levels,
+                                      uint64_t level) const {
+  if (level == 0) {
+    return static_cast<double>(levels[0].size()) /
+           std::max<uint64_t>(opt_.level0_file_num_compaction_trigger_, 1);
+  }
+  uint64_t level_bytes = 0;
+  for (auto &file : levels[level]) {
+    level_bytes += file->file_size_;
+  }
+  return static_cast<double>(level_bytes) / max_bytes_for_level(level);
+}
+
+std::optional<Compaction>
+LeveledCompactionPicker::pick(const std::vector<LevelFiles> &levels) {
+  uint64_t num_levels = std::min<uint64_t>(levels.size(), opt_.num_levels_);
+  std::optional<uint64_t> best_level;
+  double best_score = 1;
+  for (uint64_t level = 0; level + 1 < num_levels; level++) {
+    double level_score = score(levels, level);
+    if (!levels[level].empty() && level_score >= best_score) {
+      best_level = level;
+      best_score = level_score;
+    }
+  }
+  if (!best_level.has_value()) {
+    return std::nullopt;
+  }
+
+  uint64_t level = best_level.value();
+  Compaction compaction{
+      .inputs_ = {CompactionInput{.level_ = level, .files_ = {}}},
+      .output_level_ = level + 1};
+  auto &input_level = levels[level];
+  auto &inputs = compaction.inputs_.front().files_;
+  if (level == 0) {
+    // level 0 SSTs overlap each other, they all go down together
+    inputs = input_level;
+  } else {
+    auto &pointer = compact_pointer_[level];
+    auto it = std::ranges::find_if(input_level, [&pointer](auto &file) {
+      return compare_bytes(file->smallest_key_, pointer) > 0;
+    });
+    if (it == input_level.end() || pointer.empty()) {
+      it = input_level.begin();
+    }
+    inputs.push_back(*it);
+    pointer = (*it)->largest_key_;
+  }
+
+  std::vector<std::byte> smallest;
+  std::vector<std::byte> largest;
+  if (key_range(inputs, smallest, largest)) {
+    CompactionInput output_level_inputs{.level_ = compaction.output_level_,
+                                        .files_ = {}};
+    for (auto &file : levels[compaction.output_level_]) {
+      if (overlaps(*file, smallest, largest)) {
+        output_level_inputs.files_.push_back(file);
+      }
+    }
+    if (!output_level_inputs.files_.empty()) {
+      compaction.inputs_.push_back(std::move(output_level_inputs));
+    }
+  }
+  set_bottommost(levels, compaction);
+  return compaction;
+}
+
+uint64_t LeveledCompactionPicker::max_bytes_for_level(uint64_t level) const {
+  uint64_t max_bytes = std::max<uint64_t>(opt_.max_bytes_for_level_base_, 1);
+  for (uint64_t i = 1; i < level; i++) {
+    max_bytes *= opt_.max_bytes_for_level_multiplier_;
+  }
+  return max_bytes;
+}
+
+TieredCompactionPicker::TieredCompactionPicker(CompactionOptions opt)
+    : opt_(std::move(opt)) {}
+
+std::optional<Compaction>
+TieredCompactionPicker::pick(const std::vector<LevelFiles> &levels) {
+  if (std::min<uint64_t>(levels.size(), opt_.num_levels_) < 2) {
+    // level 0 runs have nowhere to go
+    return std::nullopt;
+  }
+  auto runs = sorted_runs(levels);
+  uint64_t trigger =
+      std::max<uint64_t>(opt_.level0_file_num_compaction_trigger_, 2);
+  if (runs.size() < trigger) {
+    return std::nullopt;
+  }
+
+  uint64_t newer_size = 0;
+  for (size_t i = 0; i + 1 < runs.size(); i++) {
+    newer_size += runs[i].size_;
+  }
+  if (newer_size * 100 >=
+      opt_.max_size_amplification_percent_ * runs.back().size_) {
+    return make_compaction(levels, runs, 0, runs.size() - 1);
+  }
+  if (auto compaction = pick_size_ratio(levels, runs)) {
+    return compaction;
+  }
+  // no runs of similar size, merge enough of the newest ones to fall below
+  // the trigger
+  size_t width = std::max<uint64_t>(runs.size() - trigger + 2,
+                                    opt_.min_merge_width_);
+  return make_compaction(levels, runs, 0,
+                         std::min(width, runs.size()) - 1);
+}
+
+std::vector<TieredCompactionPicker::SortedRun>
+TieredCompactionPicker::sorted_runs(const std::vector<LevelFiles> &levels) {
+  std::vector<SortedRun> runs;
+  if (levels.empty()) {
+    return runs;
+  }
+  for (auto it = levels[0].rbegin(); it != levels[0].rend(); it++) {
+    runs.push_back(SortedRun{
+        .level_ = 0, .files_ = {*it}, .size_ = (*it)->file_size_});
+  }
+  for (uint64_t level = 1; level < levels.size(); level++) {
+    if (levels[level].empty()) {
+      continue;
+    }
+    SortedRun run{.level_ = level, .files_ = levels[level], .size_ = 0};
+    for (auto &file : run.files_) {
+      run.size_ += file->file_size_;
+    }
+    runs.push_back(std::move(run));
+  }
+  return runs;
+}
+
+Compaction
+TieredCompactionPicker::make_compaction(const std::vector<LevelFiles> &levels,
+                                        const std::vector<SortedRun> &runs,
+                                        size_t first, size_t last) {
+  Compaction compaction;
+  if (runs[last].level_ == 0) {
+    // an older level 0 run left behind would read as newer than the output
+    while (last + 1 < runs.size() && runs[last + 1].level_ == 0) {
+      last++;
+    }
+    uint64_t next_level =
+        last + 1 < runs.size() ? runs[last + 1].level_ : levels.size();
+    if (next_level == 1) {
+      // no empty level between level 0 and the next older run
+      last++;
+    }
+    compaction.output_level_ = next_level == 1 ? 1 : next_level - 1;
+  } else {
+    compaction.output_level_ = runs[last].level_;
+  }
+
+  CompactionInput level0_inputs{.level_ = 0, .files_ = {}};
+  for (size_t i = first; i <= last; i++) {
+    if (runs[i].level_ == 0) {
+      level0_inputs.files_.push_back(runs[i].files_.front());
+    } else {
+      compaction.inputs_.push_back(
+          CompactionInput{.level_ = runs[i].level_, .files_ = runs[i].files_});
+    }
+  }
+  if (!level0_inputs.files_.empty()) {
+    // level 0 is kept oldest first
+    std::ranges::reverse(level0_inputs.files_);
+    compaction.inputs_.insert(compaction.inputs_.begin(),
+                              std::move(level0_inputs));
+  }
+  set_bottommost(levels, compaction);
+  return compaction;
+}
+
+std::optional<Compaction> TieredCompactionPicker::pick_size_ratio(
+    const std::vector<LevelFiles> &levels,
+    const std::vector<SortedRun> &runs) const {
+  for (size_t first = 0; first + 1 < runs.size(); first++) {
+    uint64_t candidate_size = runs[first].size_;
+    size_t last = first;
+    while (last + 1 < runs.size() &&
+           runs[last + 1].size_ * 100 <=
+               candidate_size * (100 + opt_.size_ratio_)) {
+      last++;
+      candidate_size += runs[last].size_;
+    }
+    if (last - first + 1 >= std::max<uint64_t>(opt_.min_merge_width_, 2)) {
+      return make_compaction(levels, runs, first, last);
+    }
+  }
+  return std::nullopt;
+}
+
+CompactionJob::CompactionJob(const Compaction &compaction,
+                             TableCache &table_cache, SSTConfig sst_config,
+                             uint64_t target_file_size,
+                             std::function<uint64_t()> new_file_id,
+                             uint64_t max_subcompactions,
+                             ThreadPool *thread_pool)
+    : compaction_(compaction), table_cache_(table_cache),
+      sst_config_(std::move(sst_config)), target_file_size_(target_file_size),
+      new_file_id_(std::move(new_file_id)),
+      max_subcompactions_(thread_pool ? max_subcompactions : 1),
+      thread_pool_(thread_pool) {}
+
+std::vector<std::shared_ptr<SST>> CompactionJob::run() {
+  std::vector<std::shared_ptr<SST>> inputs;
+  for (auto &input : compaction_.all_inputs()) {
+    bytes_read_ += input->file_size_;
+    // read once, the inputs must not evict the hot blocks and SSTs
+    inputs.push_back(table_cache_.open_uncached(input->id_));
+  }
+
+  auto boundaries = partition_boundaries(inputs);
+  subcompactions_ = boundaries.size() + 1;
+  std::vector<std::vector<std::shared_ptr<SST>>> partition_outputs(
+      subcompactions_);
+  std::vector<uint64_t> partition_bytes(subcompactions_, 0);
+  auto run_partition = [&](size_t partition) {
+    std::span<const std::byte> lower;
+    std::span<const std::byte> upper;
+    if (partition > 0) {
+      lower = boundaries[partition - 1];
+    }
+    if (partition < boundaries.size()) {
+      upper = boundaries[partition];
+    }
+    partition_outputs[partition] =
+        merge(inputs, lower, upper, partition_bytes[partition]);
+  };
+  if (subcompactions_ == 1) {
+    run_partition(0);
+  } else {
+    std::vector<std::future<void>> pending;
+    pending.reserve(subcompactions_);
+    for (size_t partition = 0; partition < subcompactions_; partition++) {
+      pending.emplace_back(thread_pool_->submit(
+          [&run_partition, partition]() { run_partition(partition); }));
+    }
+    // every partition must be done before the locals go away
+    std::exception_ptr error;
+    for (auto &future : pending) {
+      try {
+        future.get();
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  std::vector<std::shared_ptr<SST>> outputs;
+  for (size_t partition = 0; partition < subcompactions_; partition++) {
+    bytes_written_ += partition_bytes[partition];
+    outputs.insert(outputs.end(), partition_outputs[partition].begin(),
+                   partition_outputs[partition].end());
+  }
+  return outputs;
+}
+
+std::vector<std::vector<std::byte>> CompactionJob::partition_boundaries(
+    const std::vector<std::shared_ptr<SST>> &inputs) const {
+  std::vector<std::vector<std::byte>> boundaries;
+  if (max_subcompactions_ <= 1) {
+    return boundaries;
+  }
+  // the last key of every input block, weighted by the block size
+  std::vector<std::pair<std::span<const std::byte>, uint64_t>> blocks;
+  uint64_t total_size = 0;
+  for (auto &sst : inputs) {
+    auto &index = sst->get_index();
+    for (size_t block_idx = 0; block_idx < index.size(); block_idx++) {
+      blocks.emplace_back(index.last_key(block_idx),
+                          index.block_size(block_idx));
+      total_size += index.block_size(block_idx);
+    }
+  }
+  std::ranges::sort(blocks, [](auto &lhs, auto &rhs) {
+    return compare_bytes(lhs.first, rhs.first) < 0;
+  });
+
+  // cut at every 1/max_subcompactions_ of the input bytes
+  uint64_t accumulated = 0;
+  for (auto &[key, size] : blocks) {
+    if (boundaries.size() + 1 >= max_subcompactions_) {
+      break;
+    }
+    accumulated += size;
+    if (accumulated * max_subcompactions_ <
+            total_size * (boundaries.size() + 1) ||
+        key.empty() ||
+        (!boundaries.empty() && compare_bytes(key, boundaries.back()) <= 0)) {
+      continue;
+    }
+    boundaries.emplace_back(key.begin(), key.end());
+  }
+  return boundaries;
+}
+
+std::vector<std::shared_ptr<SST>>
+CompactionJob::merge(const std::vector<std::shared_ptr<SST>> &inputs,
+                     std::span<const std::byte> lower,
+                     std::span<const std::byte> upper,
+                     uint64_t &bytes_written) const {
+  std::vector<std::unique_ptr<Iterator>> children;
+  for (auto &input : inputs) {
+    children.push_back(std::make_unique<SSTIterator>(input));
+  }
+  MergeIterator iter(std::move(children));
+  if (!lower.empty()) {
+    iter.seek(std::vector<std::byte>(lower.begin(), lower.end()));
+  }
+
+  // SSTBuilder takes a mutable config, every partition gets its own
+  SSTConfig sst_config = sst_config_;
+  std::vector<std::shared_ptr<SST>> outputs;
+  std::unique_ptr<SSTBuilder> builder;
+  auto finish_output = [&]() {
+    auto sst = std::make_shared<SST>(builder->build());
+    bytes_written += sst->file_size();
+    outputs.push_back(std::move(sst));
+    builder.reset();
+  };
+  for (; iter.is_valid(); iter.next()) {
+    if (!upper.empty() && compare_bytes(iter.key_view(), upper) >= 0) {
+      break;
+    }
+    auto value = iter.value_view();
+    if (value.empty() && compaction_.bottommost_) {
+      continue;
+    }
+    if (!builder) {
+      builder = std::make_unique<SSTBuilder>(
+          table_cache_.sst_path(new_file_id_()), sst_config);
+    }
+    builder->add_entry(iter.key_view(), value);
+    if (builder->estimated_size() >= target_file_size_) {
+      finish_output();
+    }
+  }
+  if (builder) {
+    finish_output();
+  }
+  return outputs;
+}
+
+uint64_t CompactionJob::bytes_read() const { return bytes_read_; }
+
+uint64_t CompactionJob::bytes_written() const { return bytes_written_; }
+
+size_t CompactionJob::subcompactions() const { return subcompactions_; }
@@ -1,18 +1,166 @@
 #include "io/file_reader.hpp"
+#include "io/io_uring.hpp"
 
-FileReader::FileReader(const fs::path &path) : path_name_(path) {
-  in_ = std::ifstream(path_name_, std::ios::in | std::ios::binary);
-  file_size_ = std::filesystem::file_size(path_name_);
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <numeric>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+
+int open_file(const fs::path &path) {
+  int flags = O_RDONLY;
+#ifdef O_CLOEXEC
+  flags |= O_CLOEXEC;
+#endif
+  int fd = ::open(path.c_str(), flags);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to open file " + path.string());
+  }
+  return fd;
+}
+
+} // namespace
+
+FileReader::FileReader(const fs::path &path, Backend backend)
+    : path_name_(path), backend_(backend) {
+  fd_ = open_file(path_name_);
+  struct stat st{};
+  if (::fstat(fd_, &st) != 0) {
+    int err = errno;
+    ::close(fd_);
+    throw std::system_error(err, std::generic_category(), "fstat failed");
+  }
+  file_size_ = static_cast<uint64_t>(st.st_size);
 }
 
 void FileReader::read(size_t offsets, size_t length,
                       std::vector<std::byte> &buffer) {
-  in_.seekg(offsets);
-  in_.read(reinterpret_cast<char *>(buffer.data()), length);
+  if (buffer.size() < length) {
+    throw std::invalid_argument("read buffer is smaller than the length");
+  }
+  ensure_open();
+  iovec iov{.iov_base = buffer.data(), .iov_len = length};
+  read_all(std::span<iovec>(&iov, 1), offsets);
+}
+
+void FileReader::read_batch(std::span<ReadRequest> requests) {
+  ensure_open();
+  IoUring *ring =
+      backend_ == Backend::IO_URING ? IoUring::for_this_thread() : nullptr;
+  if (ring == nullptr) {
+    preadv_batch(requests);
+    return;
+  }
+
+  // io_uring advances the requests it could not finish, pread does the rest
+  std::vector<ReadRequest> remaining(requests.begin(), requests.end());
+  for (auto request_idx : ring->read(fd_, remaining)) {
+    auto &request = remaining[request_idx];
+    iovec iov{.iov_base = request.buffer_.data(),
+              .iov_len = request.buffer_.size()};
+    read_all(std::span<iovec>(&iov, 1), request.offset_);
+  }
+}
+
+FileReader::Backend FileReader::backend() const {
+  if (backend_ == Backend::IO_URING && IoUring::for_this_thread() != nullptr) {
+    return Backend::IO_URING;
+  }
+  return Backend::PREAD;
 }
 
-void FileReader::close() { in_.close(); }
+void FileReader::preadv_batch(std::span<ReadRequest> requests) {
+  std::vector<size_t> order(requests.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::sort(order, {}, [&](size_t idx) {
+    return requests[idx].offset_;
+  });
+
+  std::vector<iovec> iovecs;
+  size_t run_start = 0;
+  while (run_start < order.size()) {
+    // extend the run while the next request starts where the previous ends
+    iovecs.clear();
+    uint64_t run_offset = requests[order[run_start]].offset_;
+    uint64_t run_end = run_offset;
+    size_t run_idx = run_start;
+    while (run_idx < order.size() && iovecs.size() < IOV_MAX) {
+      auto &request = requests[order[run_idx]];
+      if (request.offset_ != run_end) {
+        break;
+      }
+      iovecs.push_back(iovec{.iov_base = request.buffer_.data(),
+                                    .iov_len = request.buffer_.size()});
+      run_end += request.buffer_.size();
+      run_idx++;
+    }
+    read_all(iovecs, run_offset);
+    run_start = run_idx;
+  }
+}
+
+void FileReader::close() {
+  if (fd_ == -1) {
+    return;
+  }
+  if (::close(fd_) != 0) {
+    throw std::system_error(errno, std::generic_category(), "close failed");
+  }
+  fd_ = -1;
+}
 
 uint64_t FileReader::file_size() { return file_size_; }
 
-FileReader::~FileReader() { close(); }
+FileReader::~FileReader() {
+  try {
+    close();
+  } catch (...) {
+    // Destructors must not throw
+  }
+}
+
+void FileReader::ensure_open() const {
+  if (fd_ == -1) {
+    throw std::runtime_error("file descriptor is not open");
+  }
+}
+
+void FileReader::read_all(std::span<iovec> iovecs, uint64_t offset) {
+  while (!iovecs.empty() && iovecs.front().iov_len == 0) {
+    iovecs = iovecs.subspan(1);
+  }
+  while (!iovecs.empty()) {
+    ssize_t rv = ::preadv(fd_, iovecs.data(), iovecs.size(), offset);
+    if (rv < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(), "pread failed");
+    }
+    if (rv == 0) {
+      throw std::runtime_error("read past the end of " + path_name_.string());
+    }
+
+    // drop the filled iovecs and shrink the partially filled one
+    offset += rv;
+    size_t remaining = static_cast<size_t>(rv);
+    // zero length iovecs are dropped too, so preadv never reads nothing
+    while (!iovecs.empty() && remaining >= iovecs.front().iov_len) {
+      remaining -= iovecs.front().iov_len;
+      iovecs = iovecs.subspan(1);
+    }
+    if (!iovecs.empty()) {
+      iovecs.front().iov_base =
+          static_cast<std::byte *>(iovecs.front().iov_base) + remaining;
+      iovecs.front().iov_len -= remaining;
+    }
+  }
+}
@@ -38,6 +38,21 @@ void fsync_with_full_barrier(int fd) {
 
 } // namespace
 
+void sync_directory(const fs::path &directory) {
+  int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to open directory " + directory.string());
+  }
+  try {
+    fsync_with_full_barrier(fd);
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+}
+
 FileWriter::FileWriter(const fs::path &path) : path_name_(path) {
   auto parent = path_name_.parent_path();
   if (!parent.empty() && !fs::exists(parent)) {
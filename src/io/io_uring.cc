@@ -0,0 +1,198 @@
+#include "io/io_uring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+
+void *map_ring(int fd, size_t size, uint64_t offset) {
+  void *addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, offset);
+  return addr == MAP_FAILED ? nullptr : addr;
+}
+
+template <typename T> T *ring_field(void *ring, uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<std::byte *>(ring) + offset);
+}
+
+} // namespace
+
+IoUring *IoUring::for_this_thread() {
+  thread_local std::unique_ptr<IoUring> ring(create());
+  return ring.get();
+}
+
+IoUring *IoUring::create() {
+  io_uring_params params{};
+  int fd = static_cast<int>(
+      ::syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params));
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  std::unique_ptr<IoUring> ring(new IoUring());
+  ring->ring_fd_ = fd;
+  ring->sq_entries_ = params.sq_entries;
+  ring->sq_ring_size_ =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    ring->sq_ring_size_ = ring->cq_ring_size_ =
+        std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+  }
+
+  ring->sq_ring_ = map_ring(fd, ring->sq_ring_size_, IORING_OFF_SQ_RING);
+  if (ring->sq_ring_ == nullptr) {
+    return nullptr;
+  }
+  ring->cq_ring_ = single_mmap
+                       ? ring->sq_ring_
+                       : map_ring(fd, ring->cq_ring_size_, IORING_OFF_CQ_RING);
+  if (ring->cq_ring_ == nullptr) {
+    return nullptr;
+  }
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  ring->sqes_ = static_cast<io_uring_sqe *>(
+      map_ring(fd, ring->sqes_size_, IORING_OFF_SQES));
+  if (ring->sqes_ == nullptr) {
+    return nullptr;
+  }
+
+  ring->sq_tail_ = ring_field<unsigned>(ring->sq_ring_, params.sq_off.tail);
+  ring->sq_mask_ =
+      *ring_field<unsigned>(ring->sq_ring_, params.sq_off.ring_mask);
+  ring->sq_array_ = ring_field<unsigned>(ring->sq_ring_, params.sq_off.array);
+  ring->cq_head_ = ring_field<unsigned>(ring->cq_ring_, params.cq_off.head);
+  ring->cq_tail_ = ring_field<unsigned>(ring->cq_ring_, params.cq_off.tail);
+  ring->cq_mask_ =
+      *ring_field<unsigned>(ring->cq_ring_, params.cq_off.ring_mask);
+  ring->cqes_ = ring_field<io_uring_cqe>(ring->cq_ring_, params.cq_off.cqes);
+  return ring.release();
+}
+
+std::vector<size_t>
+IoUring::read(int fd, std::span<FileReader::ReadRequest> requests) {
+  // the kernel reads the iovecs at completion time, they must stay put
+  std::vector<iovec> iovecs(requests.size());
+  std::vector<size_t> incomplete;
+  size_t next = 0;
+  unsigned in_flight = 0;
+
+  while (next < requests.size() || in_flight > 0) {
+    // we are the only producer, the tail is ours to read without ordering
+    unsigned tail = *sq_tail_;
+    unsigned to_submit = 0;
+    while (next < requests.size() && in_flight + to_submit < sq_entries_) {
+      auto &request = requests[next];
+      if (!request.buffer_.empty()) {
+        iovecs[next] = iovec{.iov_base = request.buffer_.data(),
+                             .iov_len = request.buffer_.size()};
+        unsigned idx = tail & sq_mask_;
+        io_uring_sqe &sqe = sqes_[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        // READV rather than READ, it is available since the first io_uring
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(&iovecs[next]);
+        sqe.len = 1;
+        sqe.off = request.offset_;
+        sqe.user_data = next;
+        sq_array_[idx] = idx;
+        tail++;
+        to_submit++;
+      }
+      next++;
+    }
+    if (to_submit == 0 && in_flight == 0) {
+      break;
+    }
+    std::atomic_ref<unsigned>(*sq_tail_).store(tail,
+                                               std::memory_order_release);
+
+    unsigned submitted = 0;
+    int err = enter(to_submit, 1, submitted);
+    in_flight += submitted;
+    if (err != 0) {
+      // take back the entries the kernel did not consume, and wait for the
+      // ones in flight since the kernel may still write into their buffers
+      std::atomic_ref<unsigned>(*sq_tail_).store(
+          tail - (to_submit - submitted), std::memory_order_release);
+      while (in_flight > 0) {
+        unsigned ignored = 0;
+        enter(0, 1, ignored);
+        unsigned head = *cq_head_;
+        unsigned cq_tail = std::atomic_ref<unsigned>(*cq_tail_).load(
+            std::memory_order_acquire);
+        in_flight -= cq_tail - head;
+        std::atomic_ref<unsigned>(*cq_head_).store(cq_tail,
+                                                   std::memory_order_release);
+      }
+      throw std::system_error(err, std::generic_category(),
+                              "io_uring_enter failed");
+    }
+
+    unsigned head = *cq_head_;
+    unsigned cq_tail =
+        std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+    for (; head != cq_tail; head++) {
+      const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+      size_t request_idx = cqe.user_data;
+      auto &request = requests[request_idx];
+      size_t bytes_read = cqe.res > 0 ? static_cast<size_t>(cqe.res) : 0;
+      if (bytes_read < request.buffer_.size()) {
+        request.offset_ += bytes_read;
+        request.buffer_ = request.buffer_.subspan(bytes_read);
+        incomplete.push_back(request_idx);
+      }
+      in_flight--;
+    }
+    std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+  }
+  return incomplete;
+}
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) {
+    ::munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    ::munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    ::munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ != -1) {
+    ::close(ring_fd_);
+  }
+}
+
+int IoUring::enter(unsigned to_submit, unsigned wait_nr,
+                   unsigned &submitted) {
+  while (true) {
+    int rv = static_cast<int>(
+        ::syscall(__NR_io_uring_enter, ring_fd_, to_submit - submitted,
+                  wait_nr, IORING_ENTER_GETEVENTS, nullptr, 0));
+    if (rv >= 0) {
+      submitted += std::min<unsigned>(rv, to_submit - submitted);
+      if (submitted == to_submit) {
+        return 0;
+      }
+      continue;
+    }
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+      continue;
+    }
+    return errno;
+  }
+}
@@ -0,0 +1,73 @@
+#include "io/mmap_file.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+MmapFile::MmapFile(const fs::path &path) : path_name_(path) {
+  int flags = O_RDONLY;
+#ifdef O_CLOEXEC
+  flags |= O_CLOEXEC;
+#endif
+  int fd = ::open(path_name_.c_str(), flags);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to open file " + path_name_.string());
+  }
+  struct stat st{};
+  if (::fstat(fd, &st) != 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::system_error(err, std::generic_category(), "fstat failed");
+  }
+  file_size_ = static_cast<uint64_t>(st.st_size);
+
+  // an empty file can not be mapped, it is served as an empty span
+  if (file_size_ > 0) {
+    void *addr = ::mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(),
+                              "failed to mmap " + path_name_.string());
+    }
+    data_ = static_cast<std::byte *>(addr);
+  }
+  // the mapping stays valid after the descriptor is closed
+  ::close(fd);
+  advise(MADV_RANDOM);
+}
+
+std::span<const std::byte> MmapFile::data() const {
+  return {data_, static_cast<size_t>(file_size_)};
+}
+
+uint64_t MmapFile::file_size() const { return file_size_; }
+
+void MmapFile::begin_sequential_read() {
+  if (sequential_readers_.fetch_add(1, std::memory_order_relaxed) == 0) {
+    advise(MADV_SEQUENTIAL);
+  }
+}
+
+void MmapFile::end_sequential_read() {
+  if (sequential_readers_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+    advise(MADV_RANDOM);
+  }
+}
+
+MmapFile::~MmapFile() {
+  if (data_ != nullptr) {
+    ::munmap(data_, file_size_);
+  }
+}
+
+void MmapFile::advise(int advice) {
+  // only a hint, racing transitions may leave the older advice in place
+  if (data_ != nullptr) {
+    ::madvise(data_, file_size_, advice);
+  }
+}
@@ -1,38 +1,155 @@
 #include "manifest/manifest.hpp"
-#include "io/file_reader.hpp"
+#include "utils.hpp"
 #include "version_edit.hpp"
+#include <cstring>
+#include <format>
 #include <fstream>
-#include <iostream>
-#include <nlohmann/json.hpp>
-using json = nlohmann::json;
+#include <stdexcept>
+#include <string>
 
-// NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(VersionEdit, new_files_, wal_addition_);
+namespace {
+const std::string CURRENT_FILE_NAME = "CURRENT";
+const std::string MANIFEST_PREFIX = "MANIFEST-";
 
-Manifest::Manifest(const std::filesystem::path &path)
-    : writer_(std::make_unique<FileWriter>(path)) {}
+std::vector<std::byte> read_file(const std::filesystem::path &path) {
+  std::vector<std::byte> data(std::filesystem::file_size(path));
+  std::ifstream in{path, std::ios::binary};
+  in.read(reinterpret_cast<char *>(data.data()), data.size());
+  if (!in) {
+    throw std::runtime_error("failed to read " + path.string());
+  }
+  return data;
+}
+} // namespace
+
+Manifest::Manifest(const std::filesystem::path &directory,
+                   uint64_t manifest_number)
+    : directory_(directory), manifest_number_(manifest_number),
+      writer_(std::make_unique<FileWriter>(
+          manifest_path(directory, manifest_number))) {
+  file_size_ = writer_->file_size();
+}
 
 std::pair<Manifest, std::vector<VersionEdit>>
-Manifest::recover(const std::filesystem::path &path) {
-  if (!std::filesystem::exists(path)) {
-    return {std::move(Manifest{path}), {}};
+Manifest::recover(const std::filesystem::path &directory) {
+  std::filesystem::create_directories(directory);
+  auto current_path = directory / CURRENT_FILE_NAME;
+  if (!std::filesystem::exists(current_path)) {
+    std::filesystem::remove(manifest_path(directory, 1));
+    Manifest manifest{directory, 1};
+    manifest.write_current(1);
+    return {std::move(manifest), std::vector<VersionEdit>{}};
+  }
+
+  std::string file_name;
+  {
+    std::ifstream in{current_path};
+    std::getline(in, file_name);
   }
+  if (!file_name.starts_with(MANIFEST_PREFIX) ||
+      file_name.size() == MANIFEST_PREFIX.size() ||
+      file_name.find_first_not_of("0123456789", MANIFEST_PREFIX.size()) !=
+          std::string::npos) {
+    throw std::runtime_error("malformed " + current_path.string());
+  }
+  uint64_t manifest_number =
+      std::stoull(file_name.substr(MANIFEST_PREFIX.size()));
+  auto path = directory / file_name;
+  auto data = read_file(path);
 
   std::vector<VersionEdit> records;
-  std::ifstream in_{path};
-  std::string line;
-  while (std::getline(in_, line)) {
-    auto j = json::parse(line);
-    auto record = j.get<VersionEdit>();
-    records.push_back(record);
+  const size_t header_size =
+      RECORD_LENGTH_ENCODED_SIZE + RECORD_CHECKSUM_ENCODED_SIZE;
+  size_t offset = 0;
+  while (data.size() - offset >= header_size) {
+    auto record = std::span<const std::byte>(data).subspan(offset);
+    uint32_t length =
+        decode_uint32_t(record.subspan<0, RECORD_LENGTH_ENCODED_SIZE>());
+    uint32_t checksum = decode_uint32_t(
+        record.subspan<RECORD_LENGTH_ENCODED_SIZE,
+                       RECORD_CHECKSUM_ENCODED_SIZE>());
+    if (record.size() - header_size < length) {
+      break;
+    }
+    auto payload = record.subspan(header_size, length);
+    if (crc32c(payload) != checksum) {
+      if (header_size + length == record.size()) {
+        break;
+      }
+      throw std::runtime_error("corrupted record in " + path.string());
+    }
+    records.push_back(VersionEdit::decode(payload));
+    offset += header_size + length;
+  }
+  if (offset < data.size()) {
+    // drop the torn record, the next ones are appended after the valid ones
+    std::filesystem::resize_file(path, offset);
+  }
+
+  // manifests of a rewrite that a crash interrupted
+  for (auto &entry : std::filesystem::directory_iterator(directory)) {
+    auto name = entry.path().filename().string();
+    if ((name.starts_with(MANIFEST_PREFIX) && name != file_name) ||
+        name == CURRENT_FILE_NAME + ".tmp") {
+      std::filesystem::remove(entry.path());
+    }
   }
-  return {std::move(Manifest{path}), records};
+  return {Manifest{directory, manifest_number}, std::move(records)};
 }
 
 void Manifest::add_record(const VersionEdit &record) {
-  auto encoded_json = json(record).dump();
-  encoded_json.append("\n");
   std::vector<std::byte> bytes;
-  bytes.resize(encoded_json.size());
-  std::memcpy(bytes.data(), encoded_json.data(), encoded_json.size());
+  encode_record(record, bytes);
   writer_->append_and_sync(bytes);
+  file_size_ += bytes.size();
+}
+
+void Manifest::rewrite(std::span<const VersionEdit> snapshot) {
+  uint64_t manifest_number = manifest_number_ + 1;
+  auto path = manifest_path(directory_, manifest_number);
+  std::filesystem::remove(path);
+  auto writer = std::make_unique<FileWriter>(path);
+  std::vector<std::byte> bytes;
+  for (auto &record : snapshot) {
+    encode_record(record, bytes);
+  }
+  writer->append_and_sync(bytes);
+
+  // a failed CURRENT switch leaves this manifest on the old file
+  write_current(manifest_number);
+  auto old_path = manifest_path(directory_, manifest_number_);
+  manifest_number_ = manifest_number;
+  writer_ = std::move(writer);
+  file_size_ = bytes.size();
+  std::filesystem::remove(old_path);
+}
+
+uint64_t Manifest::file_size() const { return file_size_; }
+
+void Manifest::encode_record(const VersionEdit &record,
+                             std::vector<std::byte> &out) {
+  auto payload = record.encode();
+  out.append_range(encode_uint32_t(payload.size()));
+  out.append_range(encode_uint32_t(crc32c(payload)));
+  out.append_range(payload);
+}
+
+std::filesystem::path Manifest::manifest_path(const std::filesystem::path &dir,
+                                              uint64_t manifest_number) {
+  return dir / std::format("{}{:06}", MANIFEST_PREFIX, manifest_number);
+}
+
+void Manifest::write_current(uint64_t manifest_number) const {
+  auto tmp_path = directory_ / (CURRENT_FILE_NAME + ".tmp");
+  std::filesystem::remove(tmp_path);
+  {
+    auto file_name =
+        manifest_path(directory_, manifest_number).filename().string() + "\n";
+    std::vector<std::byte> bytes(file_name.size());
+    std::memcpy(bytes.data(), file_name.data(), file_name.size());
+    FileWriter writer(tmp_path);
+    writer.append_and_sync(bytes);
+  }
+  std::filesystem::rename(tmp_path, directory_ / CURRENT_FILE_NAME);
+  sync_directory(directory_);
 }
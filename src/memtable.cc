@@ -2,9 +2,21 @@
 #include "sst/sst.hpp"
 #include "sst/sst_builder.hpp"
 #include "wal/wal.hpp"
+#include <algorithm>
+#include <bit>
 #include <filesystem>
 #include <format>
-#include <mutex>
+
+namespace {
+// an eighth of the cap, so a small memtable does not reserve a whole
+// DEFAULT_CHUNK_SIZE chunk that size() would not see
+size_t arena_chunk_size(uint64_t cap_size) {
+  size_t min_chunk_size = MemTable::MIN_ARENA_CHUNK_SIZE;
+  size_t max_chunk_size = Arena::DEFAULT_CHUNK_SIZE;
+  return std::clamp<size_t>(std::bit_floor(cap_size / 8), min_chunk_size,
+                            max_chunk_size);
+}
+} // namespace
 
 std::unique_ptr<MemTable> MemTable::recover(const std::filesystem::path &path,
                                             uint64_t id, uint64_t cap_size) {
@@ -18,43 +30,35 @@ std::unique_ptr<MemTable> MemTable::recover(const std::filesystem::path &path,
 }
 
 MemTable::MemTable(uint64_t size, uint64_t id)
-    : approximate_size_(0), cap_size_(size), status_(Status::Mutable), id_(id) {
-  storage_ = std::make_shared<MemTableStorage>();
+    : cap_size_(size), status_(Status::Mutable), id_(id) {
+  storage_ = std::make_shared<MemTableStorage>(arena_chunk_size(size));
 }
 
 std::optional<std::vector<std::byte>>
-MemTable::get(const std::vector<std::byte> &key) {
-  std::shared_lock lk{shared_mu_};
-  if (storage_->contains(key)) {
-    return storage_->at(key);
-  }
-  return std::nullopt;
+MemTable::get(const std::vector<std::byte> &key, uint64_t sequence) {
+  return storage_->get(key, sequence);
 }
 
 void MemTable::put(const std::vector<std::byte> &key,
-                   const std::vector<std::byte> &value) {
-  std::lock_guard lk{shared_mu_};
-  if (status_ == Status::Immutable) {
+                   const std::vector<std::byte> &value, uint64_t sequence) {
+  if (status_.load(std::memory_order_acquire) == Status::Immutable) {
     throw std::runtime_error("write to immutable");
   }
 
-  if (storage_->contains(key)) {
-    approximate_size_ -= storage_->at(key).size();
-    approximate_size_ += value.size();
-  } else {
-    approximate_size_ += key.size() + value.size();
-  }
-  storage_->insert_or_assign(key, value);
+  storage_->insert(key, value, sequence);
 }
 
 ImmutableMemTableIterator MemTable::get_iteartor() {
-  std::lock_guard lk{shared_mu_};
-  if (status_ != Status::Immutable) {
+  if (status_.load(std::memory_order_acquire) != Status::Immutable) {
     throw std::runtime_error("get_iterator for mutable mem_table");
   }
   return ImmutableMemTableIterator{storage_};
 }
 
+std::unique_ptr<Iterator> MemTable::new_scan_iterator(uint64_t sequence) {
+  return std::make_unique<ImmutableMemTableIterator>(storage_, sequence);
+}
+
 SST MemTable::flush(SSTConfig &sst_config) {
   auto filename = std::format("sst_{}", id_);
   const std::filesystem::path sst_path =
@@ -63,48 +67,57 @@ SST MemTable::flush(SSTConfig &sst_config) {
   SSTBuilder sst_builder(sst_path, sst_config);
   auto mem_table_iter = get_iteartor();
   while (mem_table_iter.is_valid()) {
-    auto key = mem_table_iter.key();
-    auto value = mem_table_iter.value();
-    sst_builder.add_entry(key, value);
+    sst_builder.add_entry(mem_table_iter.key_view(),
+                          mem_table_iter.value_view());
     mem_table_iter.next();
   }
 
   return sst_builder.build();
 }
 
-uint64_t MemTable::get_id() {
-  std::shared_lock lk{shared_mu_};
-  return id_;
-}
+uint64_t MemTable::get_id() { return id_; }
 
 ImmutableMemTableIterator::ImmutableMemTableIterator(
-    std::shared_ptr<MemTableStorage> storage)
-    : storage_(storage) {
-  curr_it_ = storage_->begin();
+    std::shared_ptr<MemTableStorage> storage, uint64_t sequence)
+    : storage_(storage), sequence_(sequence), curr_value_(nullptr) {
+  curr_node_ = storage_->first();
+  skip_invisible();
 }
 
-bool ImmutableMemTableIterator::is_valid() {
-  return curr_it_ != storage_->end();
-}
+bool ImmutableMemTableIterator::is_valid() { return curr_node_ != nullptr; }
 
-std::vector<std::byte> ImmutableMemTableIterator::key() {
+std::span<const std::byte> ImmutableMemTableIterator::key_view() {
   if (!is_valid()) {
     return {};
   }
-  return curr_it_->first;
+  return curr_node_->key();
 }
 
-std::vector<std::byte> ImmutableMemTableIterator::value() {
+std::span<const std::byte> ImmutableMemTableIterator::value_view() {
   if (!is_valid()) {
     return {};
   }
-  return curr_it_->second;
+  return curr_value_->data();
 }
 
 void ImmutableMemTableIterator::next() {
-  if (curr_it_ != storage_->end()) {
-    curr_it_ = std::next(curr_it_);
-    if (curr_it_ == storage_->end())
+  if (curr_node_ != nullptr) {
+    curr_node_ = curr_node_->next(0);
+    skip_invisible();
+  }
+}
+
+void ImmutableMemTableIterator::seek(const std::vector<std::byte> &target) {
+  curr_node_ = storage_->seek(target);
+  skip_invisible();
+}
+
+void ImmutableMemTableIterator::skip_invisible() {
+  while (curr_node_ != nullptr) {
+    curr_value_ = curr_node_->value_at(sequence_);
+    if (curr_value_ != nullptr) {
       return;
+    }
+    curr_node_ = curr_node_->next(0);
   }
 }
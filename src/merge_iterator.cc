@@ -0,0 +1,76 @@
+#include "merge_iterator.hpp"
+#include "utils.hpp"
+#include <algorithm>
+
+MergeIterator::MergeIterator(std::vector<std::unique_ptr<Iterator>> children)
+    : children_(std::move(children)) {
+  build_heap();
+}
+
+void MergeIterator::next() {
+  if (!is_valid()) {
+    return;
+  }
+
+  // advance every child positioned at the current key, the older duplicates
+  // are shadowed by the entry just returned
+  // the front key is a view into a child that is about to move
+  skip_key_.assign(heap_.front().key_.begin(), heap_.front().key_.end());
+  while (!heap_.empty() &&
+         compare_bytes(heap_.front().key_, skip_key_) == 0) {
+    std::pop_heap(heap_.begin(), heap_.end(), Greater{});
+    size_t child_idx = heap_.back().child_idx_;
+    heap_.pop_back();
+    children_[child_idx]->next();
+    push_child(child_idx);
+  }
+}
+
+void MergeIterator::seek(const std::vector<std::byte> &target) {
+  for (auto &child : children_) {
+    child->seek(target);
+  }
+  build_heap();
+}
+
+std::span<const std::byte> MergeIterator::key_view() {
+  if (!is_valid()) {
+    return {};
+  }
+  return heap_.front().key_;
+}
+
+std::span<const std::byte> MergeIterator::value_view() {
+  if (!is_valid()) {
+    return {};
+  }
+  return children_[heap_.front().child_idx_]->value_view();
+}
+
+bool MergeIterator::is_valid() { return !heap_.empty(); }
+
+bool MergeIterator::Greater::operator()(const HeapEntry &lhs,
+                                        const HeapEntry &rhs) const {
+  int cmp = compare_bytes(lhs.key_, rhs.key_);
+  if (cmp != 0) {
+    return cmp > 0;
+  }
+  return lhs.child_idx_ > rhs.child_idx_;
+}
+
+void MergeIterator::build_heap() {
+  heap_.clear();
+  heap_.reserve(children_.size());
+  for (size_t child_idx = 0; child_idx < children_.size(); child_idx++) {
+    push_child(child_idx);
+  }
+}
+
+void MergeIterator::push_child(size_t child_idx) {
+  if (!children_[child_idx]->is_valid()) {
+    return;
+  }
+  heap_.push_back(HeapEntry{.key_ = children_[child_idx]->key_view(),
+                            .child_idx_ = child_idx});
+  std::push_heap(heap_.begin(), heap_.end(), Greater{});
+}
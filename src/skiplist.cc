@@ -0,0 +1,151 @@
+#include "skiplist.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <new>
+#include <random>
+
+SkipList::SkipList(size_t arena_chunk_size)
+    : arena_(arena_chunk_size), head_(new_node({}, nullptr, MAX_HEIGHT)),
+      count_(0) {}
+
+SkipList::InsertResult SkipList::insert(std::span<const std::byte> key,
+                                        std::span<const std::byte> value,
+                                        uint64_t sequence) {
+  Node *prev[MAX_HEIGHT];
+  Node *next[MAX_HEIGHT];
+  find_splice(key, prev, next);
+
+  Value *new_val = new_value(value, sequence);
+  if (next[0] != nullptr && compare_bytes(next[0]->key(), key) == 0) {
+    return replace_value(next[0], new_val);
+  }
+
+  int height = random_height();
+  Node *node = new_node(key, new_val, height);
+  for (int level = 0; level < height; level++) {
+    while (true) {
+      node->set_next_relaxed(level, next[level]);
+      if (prev[level]->cas_next(level, next[level], node)) {
+        break;
+      }
+
+      // another writer linked a node after prev[level], search again from it
+      find_splice_for_level(key, prev[level], level, &prev[level],
+                            &next[level]);
+      if (level == 0 && next[0] != nullptr &&
+          compare_bytes(next[0]->key(), key) == 0) {
+        // a concurrent writer inserted the same key first. Our node was never
+        // published, its arena space is simply left unused.
+        return replace_value(next[0], new_val);
+      }
+    }
+  }
+
+  count_.fetch_add(1, std::memory_order_relaxed);
+  return std::nullopt;
+}
+
+std::optional<std::vector<std::byte>>
+SkipList::get(std::span<const std::byte> key, uint64_t sequence) const {
+  auto node = seek(key);
+  if (node == nullptr || compare_bytes(node->key(), key) != 0) {
+    return std::nullopt;
+  }
+  auto value = node->value_at(sequence);
+  if (value == nullptr) {
+    return std::nullopt;
+  }
+  return std::vector<std::byte>(value->data().begin(), value->data().end());
+}
+
+const SkipList::Node *SkipList::seek(std::span<const std::byte> target) const {
+  Node *x = head_;
+  Node *next = nullptr;
+  for (int level = MAX_HEIGHT - 1; level >= 0; level--) {
+    next = x->next(level);
+    while (next != nullptr && compare_bytes(next->key(), target) < 0) {
+      x = next;
+      next = x->next(level);
+    }
+  }
+  return next;
+}
+
+const SkipList::Node *SkipList::first() const { return head_->next(0); }
+
+uint64_t SkipList::count() const {
+  return count_.load(std::memory_order_relaxed);
+}
+
+size_t SkipList::memory_usage() const { return arena_.memory_usage(); }
+
+int SkipList::random_height() {
+  thread_local std::minstd_rand rng{std::random_device{}()};
+  int height = 1;
+  while (height < MAX_HEIGHT && rng() % BRANCHING == 0) {
+    height++;
+  }
+  return height;
+}
+
+SkipList::Node *SkipList::new_node(std::span<const std::byte> key,
+                                   const Value *value, int height) {
+  size_t node_bytes = sizeof(Node) + sizeof(std::atomic<Node *>) * (height - 1);
+  std::byte *mem = arena_.allocate(node_bytes + key.size());
+  Node *node = new (mem) Node;
+  std::byte *key_data = mem + node_bytes;
+  std::copy(key.begin(), key.end(), key_data);
+
+  node->key_data_ = key_data;
+  node->key_size_ = key.size();
+  node->value_.store(value, std::memory_order_relaxed);
+  node->height_ = height;
+  for (int level = 0; level < height; level++) {
+    new (&node->next_[level]) std::atomic<Node *>(nullptr);
+  }
+  return node;
+}
+
+SkipList::Value *SkipList::new_value(std::span<const std::byte> value,
+                                     uint64_t sequence) {
+  std::byte *mem = arena_.allocate(sizeof(Value) + value.size());
+  Value *val = new (mem)
+      Value{.size_ = value.size(), .sequence_ = sequence, .prev_ = nullptr};
+  std::copy(value.begin(), value.end(), mem + sizeof(Value));
+  return val;
+}
+
+void SkipList::find_splice(std::span<const std::byte> key, Node **prev,
+                           Node **next) const {
+  Node *x = head_;
+  for (int level = MAX_HEIGHT - 1; level >= 0; level--) {
+    find_splice_for_level(key, x, level, &prev[level], &next[level]);
+    x = prev[level];
+  }
+}
+
+void SkipList::find_splice_for_level(std::span<const std::byte> key,
+                                     Node *before, int level, Node **prev,
+                                     Node **next) const {
+  Node *x = before;
+  while (true) {
+    Node *n = x->next(level);
+    if (n == nullptr || compare_bytes(n->key(), key) >= 0) {
+      *prev = x;
+      *next = n;
+      return;
+    }
+    x = n;
+  }
+}
+
+size_t SkipList::replace_value(Node *node, Value *value) {
+  const Value *old = node->value_.load(std::memory_order_acquire);
+  do {
+    // readers at an older sequence follow prev_ past the new value
+    value->prev_ = old;
+  } while (!node->value_.compare_exchange_weak(old, value,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire));
+  return old->size_;
+}
@@ -2,102 +2,158 @@
 #include "utils.hpp"
 #include <algorithm>
 #include <span>
+#include <stdexcept>
+
+namespace {
+uint16_t read_uint16(std::span<const std::byte> data, size_t offset) {
+  std::span<const std::byte, 2> val_span{data.data() + offset, 2};
+  return decode_uint16_t(val_span);
+}
+} // namespace
 
 std::vector<std::byte> Block::encode() {
-  std::vector<std::byte> encoded_data;
-  encoded_data.append_range(data_);
-  for (auto &offset : offsets_) {
-    encoded_data.append_range(encode_uint16_t(offset));
-  }
-  encoded_data.append_range(encode_uint16_t(offsets_.size()));
-  return encoded_data;
+  return std::vector<std::byte>(buffer_.begin(), buffer_.end());
+}
+
+Block Block::decode(std::vector<std::byte> bytes) {
+  auto owned =
+      std::make_shared<const std::vector<std::byte>>(std::move(bytes));
+  std::span<const std::byte> data{*owned};
+  return decode(data, std::move(owned));
 }
 
-Block Block::decode(const std::vector<std::byte> &data) {
-  if (data.size() < FooterLenSize) {
+Block Block::decode(std::span<const std::byte> data,
+                    std::shared_ptr<const void> pin) {
+  if (data.size() < RestartIntervalSize + FooterLenSize) {
     throw std::runtime_error("Block data should have the footer's length");
   }
 
-  int sz = data.size();
-  std::array<std::byte, FooterLenSize> footer = {data[sz - 2], data[sz - 1]};
-  std::span<const std::byte, FooterLenSize> footer_span{footer.data(),
-                                                        footer.size()};
-  uint16_t entries_num = decode_uint16_t(footer_span);
-
-  std::vector<uint16_t> offsets;
-  offsets.resize(entries_num);
-
-  // TODO: handle the case offsets_start_idx < 0
-  size_t offsets_start_idx = sz - entries_num * OffsetSize - FooterLenSize;
-  size_t data_block_length = offsets_start_idx;
-
-  for (size_t entry_idx = 0; entry_idx < entries_num;
-       entry_idx++, offsets_start_idx += OffsetSize) {
-    std::array<std::byte, OffsetSize> offset_data{data[offsets_start_idx],
-                                                  data[offsets_start_idx + 1]};
-    std::span<const std::byte, OffsetSize> offset_span{offset_data.data(),
-                                                       offset_data.size()};
-
-    offsets[entry_idx] = decode_uint16_t(offset_span);
+  size_t sz = data.size();
+  uint16_t entries_num = read_uint16(data, sz - FooterLenSize);
+  uint16_t restart_interval =
+      read_uint16(data, sz - FooterLenSize - RestartIntervalSize);
+  if (restart_interval == 0) {
+    throw std::runtime_error("Block restart interval should not be 0");
   }
 
-  std::vector<std::byte> data_block(data.begin(),
-                                    data.begin() + data_block_length);
-
-  return Block(data_block, offsets);
+  size_t n_restarts = (entries_num + restart_interval - 1) / restart_interval;
+  size_t footer_size =
+      n_restarts * OffsetSize + RestartIntervalSize + FooterLenSize;
+  if (sz < footer_size) {
+    throw std::runtime_error("Block restarts exceed the block size");
+  }
+  size_t data_size = sz - footer_size;
+  return Block(data, std::move(pin), data_size, restart_interval,
+               entries_num);
 }
 
 Block::Entry Block::get_entry(size_t entry_idx) {
-  if (entry_idx > offsets_.size())
+  if (entry_idx >= n_entries_)
     throw std::runtime_error("out of bound entry index");
-  Block::Entry result;
-  std::span<const std::byte, 2> len_span{data_.begin() + offsets_[entry_idx],
-                                         data_.begin() + offsets_[entry_idx] +
-                                             Block::EntryKeyLenSize};
-  uint16_t key_len = decode_uint16_t(len_span);
-  result.key_.resize(key_len);
-  std::copy(data_.begin() + offsets_[entry_idx] + Block::EntryKeyLenSize,
-            data_.begin() + offsets_[entry_idx] + Block::EntryKeyLenSize +
-                key_len,
-            result.key_.begin());
-
-  size_t value_offset = offsets_[entry_idx] + Block::EntryKeyLenSize + key_len;
-  len_span = std::span<const std::byte, 2>{data_.begin() + value_offset,
-                                           data_.begin() + value_offset +
-                                               Block::EntryValueLenSize};
-  uint16_t value_len = decode_uint16_t(len_span);
-  result.value_.resize(value_len);
-  std::copy(data_.begin() + value_offset + Block::EntryValueLenSize,
-            data_.begin() + value_offset + Block::EntryValueLenSize + value_len,
-            result.value_.begin());
-  return result;
+
+  // decode forward from the closest restart point
+  size_t curr_idx = entry_idx / restart_interval_ * restart_interval_;
+  size_t offset = restart_offset(entry_idx);
+  Entry entry;
+  std::span<const std::byte> value;
+  offset = decode_entry(offset, entry.key_, value);
+  for (; curr_idx < entry_idx; curr_idx++) {
+    offset = decode_entry(offset, entry.key_, value);
+  }
+  entry.value_.assign(value.begin(), value.end());
+  return entry;
+}
+
+size_t Block::restart_offset(size_t entry_idx) const {
+  return read_uint16(buffer_,
+                     data_size_ + entry_idx / restart_interval_ * OffsetSize);
 }
 
-size_t Block::size() { return offsets_.size(); }
+size_t Block::size() { return n_entries_; }
+
+size_t Block::memory_usage() const { return sizeof(Block) + buffer_.size(); }
 
-// TODO: implement binary search for faster key finding
 std::optional<std::vector<std::byte>>
-Block::get(const std::vector<std::byte> &key) {
-  for (size_t i = 0; i < offsets_.size(); i++) {
-    auto entry = get_entry(i);
-    if (entry.key_ == key) {
-      return entry.value_;
+Block::get(std::span<const std::byte> key) {
+  size_t entry_idx = seek_restart(key);
+  if (entry_idx >= n_entries_) {
+    return std::nullopt;
+  }
+
+  size_t offset = restart_offset(entry_idx);
+  std::vector<std::byte> entry_key;
+  std::span<const std::byte> value;
+  for (; entry_idx < n_entries_; entry_idx++) {
+    offset = decode_entry(offset, entry_key, value);
+    int cmp = compare_bytes(entry_key, key);
+    if (cmp == 0) {
+      return std::vector<std::byte>(value.begin(), value.end());
+    }
+    if (cmp > 0) {
+      break;
     }
   }
   return std::nullopt;
 }
 
+size_t Block::seek_restart(std::span<const std::byte> target) {
+  if (n_entries_ == 0) {
+    return 0;
+  }
+
+  // last restart whose key is < target, the entries before it are all
+  // smaller than target
+  size_t lo = 0;
+  size_t hi = (n_entries_ - 1) / restart_interval_;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo + 1) / 2;
+    size_t offset = restart_offset(mid * restart_interval_);
+    uint16_t key_len = read_uint16(buffer_, offset + EntrySharedLenSize);
+    std::span<const std::byte> restart_key{
+        buffer_.data() + offset + EntryHeaderSize, key_len};
+    if (compare_bytes(restart_key, target) < 0) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo * restart_interval_;
+}
+
 std::vector<std::byte> Block::get_first_key() {
-  if (offsets_.size() == 0)
+  if (n_entries_ == 0)
     return std::vector<std::byte>();
 
   return get_entry(0).key_;
 }
 
 std::vector<std::byte> Block::get_last_key() {
-  if (offsets_.size() == 0) {
+  if (n_entries_ == 0) {
     return std::vector<std::byte>();
   }
 
-  return get_entry(offsets_.size() - 1).key_;
+  return get_entry(n_entries_ - 1).key_;
+}
+
+size_t Block::decode_entry(size_t offset, std::vector<std::byte> &key,
+                           std::span<const std::byte> &value) const {
+  if (offset + EntryHeaderSize > data_size_) {
+    throw std::runtime_error("corrupted block entry");
+  }
+  uint16_t shared_len = read_uint16(buffer_, offset);
+  uint16_t key_len = read_uint16(buffer_, offset + EntrySharedLenSize);
+  uint16_t value_len =
+      read_uint16(buffer_, offset + EntrySharedLenSize + EntryKeyLenSize);
+  offset += EntryHeaderSize;
+  if (shared_len > key.size() || offset + key_len + value_len > data_size_) {
+    throw std::runtime_error("corrupted block entry");
+  }
+
+  // reuses the key's capacity, no allocation once it fits the longest key
+  key.resize(shared_len);
+  key.insert(key.end(), buffer_.begin() + offset,
+             buffer_.begin() + offset + key_len);
+  offset += key_len;
+  value = std::span<const std::byte>(buffer_.data() + offset, value_len);
+  return offset + value_len;
 }
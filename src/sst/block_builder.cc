@@ -1,26 +1,58 @@
 #include "sst/block_builder.hpp"
 #include "sst/block.hpp"
 #include "utils.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+BlockBuilder::BlockBuilder(uint16_t restart_interval)
+    : restart_interval_(restart_interval), n_entries_(0) {
+  if (restart_interval_ == 0) {
+    throw std::invalid_argument("restart interval should be positive");
+  }
+}
+
 /**
  * @brief
- *  entry format in binary: key_len (2byte), key, value_len (2byte), value
- *  offset format in binary:
+ *  entry format in binary: shared_key_len (2byte), unshared_key_len (2byte),
+ *  value_len (2byte), unshared key bytes, value
+ *  every restart_interval_-th entry stores its full key and records its
+ *  offset as a restart point.
  */
-void BlockBuilder::add_entry(std::vector<std::byte> &key,
-                             std::vector<std::byte> &value) {
-  uint16_t key_size = key.size();
+void BlockBuilder::add_entry(std::span<const std::byte> key,
+                             std::span<const std::byte> value) {
+  size_t shared_len = 0;
+  if (n_entries_ % restart_interval_ == 0) {
+    restarts_.push_back(static_cast<uint16_t>(data_.size()));
+  } else {
+    auto [key_it, last_key_it] = std::ranges::mismatch(key, last_key_);
+    shared_len = key_it - key.begin();
+  }
+  uint16_t unshared_len = key.size() - shared_len;
   uint16_t value_size = value.size();
-  offsets_.push_back(static_cast<uint16_t>(size_));
 
-  data_.append_range(encode_uint16_t(key_size));
-  data_.append_range(key);
+  data_.append_range(encode_uint16_t(static_cast<uint16_t>(shared_len)));
+  data_.append_range(encode_uint16_t(unshared_len));
   data_.append_range(encode_uint16_t(value_size));
-  data_.append_range(value);
+  data_.insert(data_.end(), key.begin() + shared_len, key.end());
+  data_.insert(data_.end(), value.begin(), value.end());
 
-  size_ += Block::EntryKeyLenSize + key.size() + Block::EntryValueLenSize +
-           value.size();
+  last_key_.assign(key.begin(), key.end());
+  n_entries_++;
 }
 
-Block BlockBuilder::build() { return Block(data_, offsets_); }
+Block BlockBuilder::build() {
+  std::vector<std::byte> encoded_data;
+  encoded_data.reserve(get_size() + Block::RestartIntervalSize +
+                       Block::FooterLenSize);
+  encoded_data.append_range(data_);
+  for (auto &restart : restarts_) {
+    encoded_data.append_range(encode_uint16_t(restart));
+  }
+  encoded_data.append_range(encode_uint16_t(restart_interval_));
+  encoded_data.append_range(encode_uint16_t(n_entries_));
+  return Block::decode(std::move(encoded_data));
+}
 
-size_t BlockBuilder::get_size() { return size_; }
+size_t BlockBuilder::get_size() const {
+  return data_.size() + restarts_.size() * Block::OffsetSize;
+}
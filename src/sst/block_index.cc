@@ -0,0 +1,68 @@
+#include "sst/block_index.hpp"
+#include "utils.hpp"
+
+void BlockIndex::add(uint64_t offset, uint64_t size,
+                     std::span<const std::byte> first_key,
+                     std::span<const std::byte> last_key) {
+  keys_.insert(keys_.end(), first_key.begin(), first_key.end());
+  key_offsets_.push_back(keys_.size());
+  keys_.insert(keys_.end(), last_key.begin(), last_key.end());
+  key_offsets_.push_back(keys_.size());
+  handles_.push_back(BlockHandle{.offset_ = offset, .size_ = size});
+}
+
+void BlockIndex::shrink_to_fit() {
+  keys_.shrink_to_fit();
+  key_offsets_.shrink_to_fit();
+  handles_.shrink_to_fit();
+}
+
+size_t BlockIndex::size() const { return handles_.size(); }
+
+uint64_t BlockIndex::offset(size_t block_idx) const {
+  return handles_[block_idx].offset_;
+}
+
+uint64_t BlockIndex::block_size(size_t block_idx) const {
+  return handles_[block_idx].size_;
+}
+
+std::span<const std::byte> BlockIndex::first_key(size_t block_idx) const {
+  return key_at(2 * block_idx);
+}
+
+std::span<const std::byte> BlockIndex::last_key(size_t block_idx) const {
+  return key_at(2 * block_idx + 1);
+}
+
+size_t BlockIndex::lower_bound(std::span<const std::byte> key) const {
+  size_t lo = 0;
+  size_t hi = size();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (compare_bytes(last_key(mid), key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+std::optional<size_t> BlockIndex::find(std::span<const std::byte> key) const {
+  size_t block_idx = lower_bound(key);
+  if (block_idx == size() || compare_bytes(key, first_key(block_idx)) < 0) {
+    return std::nullopt;
+  }
+  return block_idx;
+}
+
+size_t BlockIndex::memory_usage() const {
+  return keys_.capacity() + key_offsets_.capacity() * sizeof(uint32_t) +
+         handles_.capacity() * sizeof(BlockHandle);
+}
+
+std::span<const std::byte> BlockIndex::key_at(size_t key_idx) const {
+  return std::span<const std::byte>(keys_).subspan(
+      key_offsets_[key_idx], key_offsets_[key_idx + 1] - key_offsets_[key_idx]);
+}
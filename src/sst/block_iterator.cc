@@ -1,13 +1,13 @@
 #include "sst/block_iterator.hpp"
 #include "sst/block.hpp"
+#include "utils.hpp"
 #include <algorithm>
 
 BlockIterator::BlockIterator(std::shared_ptr<Block> block_ptr)
-    : block_ptr_(block_ptr), curr_offsets_idx_(0) {
+    : block_ptr_(block_ptr), curr_offsets_idx_(0), next_offset_(0) {
   if (block_ptr_->size() > 0) {
-    auto entry = block_ptr_->get_entry(curr_offsets_idx_);
-    curr_record_ = Record{.key_ = std::move(entry.key_),
-                          .value_ = std::move(entry.value_)};
+    next_offset_ = block_ptr_->decode_entry(block_ptr_->restart_offset(0),
+                                            curr_key_, curr_value_);
   }
 }
 
@@ -16,15 +16,31 @@ void BlockIterator::next() {
     curr_offsets_idx_++;
     if (curr_offsets_idx_ >= block_ptr_->size())
       return;
-    auto entry = block_ptr_->get_entry(curr_offsets_idx_);
-    curr_record_ = Record{.key_ = std::move(entry.key_),
-                          .value_ = std::move(entry.value_)};
+    // the current key is the base the next entry's shared prefix refers to
+    next_offset_ =
+        block_ptr_->decode_entry(next_offset_, curr_key_, curr_value_);
   }
 }
 
-std::vector<std::byte> BlockIterator::key() { return curr_record_.key_; }
+void BlockIterator::seek(const std::vector<std::byte> &target) {
+  curr_offsets_idx_ = block_ptr_->seek_restart(target);
+  if (curr_offsets_idx_ >= block_ptr_->size()) {
+    curr_offsets_idx_ = block_ptr_->size();
+    return;
+  }
+  next_offset_ =
+      block_ptr_->decode_entry(block_ptr_->restart_offset(curr_offsets_idx_),
+                               curr_key_, curr_value_);
+  while (compare_bytes(curr_key_, target) < 0) {
+    next();
+    if (!is_valid())
+      return;
+  }
+}
+
+std::span<const std::byte> BlockIterator::key_view() { return curr_key_; }
 
-std::vector<std::byte> BlockIterator::value() { return curr_record_.value_; }
+std::span<const std::byte> BlockIterator::value_view() { return curr_value_; }
 
 bool BlockIterator::is_valid() {
   return curr_offsets_idx_ < block_ptr_->size();
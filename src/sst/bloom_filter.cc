@@ -0,0 +1,92 @@
+#include "sst/bloom_filter.hpp"
+#include <algorithm>
+#include <cstring>
+
+uint32_t BloomFilter::hash(std::span<const std::byte> key) {
+  // murmur-like hash, same construction as LevelDB's Hash()
+  const uint32_t seed = 0xbc9f1d34;
+  const uint32_t m = 0xc6a4a793;
+  const uint32_t r = 24;
+  uint32_t h = seed ^ (key.size() * m);
+
+  size_t i = 0;
+  for (; i + 4 <= key.size(); i += 4) {
+    uint32_t w;
+    std::memcpy(&w, key.data() + i, sizeof(w));
+    h += w;
+    h *= m;
+    h ^= (h >> 16);
+  }
+
+  switch (key.size() - i) {
+  case 3:
+    h += static_cast<uint32_t>(key[i + 2]) << 16;
+    [[fallthrough]];
+  case 2:
+    h += static_cast<uint32_t>(key[i + 1]) << 8;
+    [[fallthrough]];
+  case 1:
+    h += static_cast<uint32_t>(key[i]);
+    h *= m;
+    h ^= (h >> r);
+    break;
+  }
+  return h;
+}
+
+std::vector<std::byte>
+BloomFilter::build(const std::vector<uint32_t> &key_hashes,
+                   size_t bits_per_key) {
+  if (bits_per_key == 0 || key_hashes.empty()) {
+    return {};
+  }
+
+  // k = bits_per_key * ln(2) minimizes the false positive rate
+  uint8_t n_probes = static_cast<uint8_t>(
+      std::clamp<size_t>(bits_per_key * 69 / 100, 1, MAX_PROBES));
+  size_t n_bits = std::max(key_hashes.size() * bits_per_key, MIN_BITS);
+  size_t n_bytes = (n_bits + 7) / 8;
+  n_bits = n_bytes * 8;
+
+  std::vector<std::byte> data(n_bytes + 1, std::byte{0});
+  for (uint32_t h : key_hashes) {
+    uint32_t delta = (h >> 17) | (h << 15);
+    for (uint8_t probe = 0; probe < n_probes; probe++) {
+      size_t bit = h % n_bits;
+      data[bit / 8] |= std::byte{static_cast<uint8_t>(1 << (bit % 8))};
+      h += delta;
+    }
+  }
+  data[n_bytes] = std::byte{n_probes};
+  return data;
+}
+
+BloomFilter::BloomFilter(std::vector<std::byte> data)
+    : data_(std::move(data)) {}
+
+bool BloomFilter::may_contain(std::span<const std::byte> key) const {
+  if (data_.size() < 2) {
+    return true;
+  }
+
+  size_t n_bits = (data_.size() - 1) * 8;
+  uint8_t n_probes = static_cast<uint8_t>(data_.back());
+  if (n_probes > MAX_PROBES) {
+    // not a filter built by build(), do not filter anything
+    return true;
+  }
+
+  uint32_t h = hash(key);
+  uint32_t delta = (h >> 17) | (h << 15);
+  for (uint8_t probe = 0; probe < n_probes; probe++) {
+    size_t bit = h % n_bits;
+    if ((data_[bit / 8] & std::byte{static_cast<uint8_t>(1 << (bit % 8))}) ==
+        std::byte{0}) {
+      return false;
+    }
+    h += delta;
+  }
+  return true;
+}
+
+size_t BloomFilter::size() const { return data_.size(); }
@@ -0,0 +1,63 @@
+#include "sst/level_iterator.hpp"
+#include "utils.hpp"
+#include <algorithm>
+
+LevelIterator::LevelIterator(
+    std::shared_ptr<TableCache> table_cache,
+    std::vector<std::shared_ptr<const SSTHandle>> files)
+    : table_cache_(std::move(table_cache)), files_(std::move(files)),
+      file_idx_(files_.size()) {}
+
+void LevelIterator::next() {
+  if (!is_valid()) {
+    return;
+  }
+  file_iterator_->next();
+  skip_exhausted_files();
+}
+
+void LevelIterator::seek(const std::vector<std::byte> &target) {
+  // the first file whose largest key is >= target holds the entry, if any
+  auto it = std::ranges::lower_bound(
+      files_, std::span<const std::byte>(target),
+      [](std::span<const std::byte> lhs, std::span<const std::byte> rhs) {
+        return compare_bytes(lhs, rhs) < 0;
+      },
+      [](const std::shared_ptr<const SSTHandle> &file) {
+        return std::span<const std::byte>(file->largest_key_);
+      });
+  file_idx_ = it - files_.begin();
+  open_file();
+  if (file_iterator_) {
+    file_iterator_->seek(target);
+  }
+  skip_exhausted_files();
+}
+
+std::span<const std::byte> LevelIterator::key_view() {
+  return file_iterator_->key_view();
+}
+
+std::span<const std::byte> LevelIterator::value_view() {
+  return file_iterator_->value_view();
+}
+
+bool LevelIterator::is_valid() {
+  return file_iterator_ && file_iterator_->is_valid();
+}
+
+void LevelIterator::open_file() {
+  // release the previous file before opening the next one
+  file_iterator_.reset();
+  if (file_idx_ < files_.size()) {
+    auto sst = table_cache_->get(files_[file_idx_]->id_);
+    file_iterator_ = std::make_unique<SSTIterator>(std::move(sst));
+  }
+}
+
+void LevelIterator::skip_exhausted_files() {
+  while (file_iterator_ && !file_iterator_->is_valid()) {
+    file_idx_++;
+    open_file();
+  }
+}
@@ -3,114 +3,293 @@
 #include "io/file_reader.hpp"
 #include "sst/block.hpp"
 #include "utils.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <memory>
 #include <ranges>
 
-SST::SST(const std::filesystem::path &file_name) {
+SST::SST(const std::filesystem::path &file_name,
+         std::shared_ptr<BlockCache> block_cache, SSTReadMode read_mode)
+    : block_cache_(std::move(block_cache)), read_mode_(read_mode) {
   id_ = parse_id_from_file_name(file_name);
-  io_ = std::make_unique<FileReader>(file_name);
+  if (read_mode == SSTReadMode::MMAP) {
+    mmap_ = std::make_shared<MmapFile>(file_name);
+    // views into the mapping are as cheap as cached blocks
+    block_cache_.reset();
+  } else {
+    io_ = std::make_unique<FileReader>(
+        file_name, read_mode == SSTReadMode::IO_URING
+                       ? FileReader::Backend::IO_URING
+                       : FileReader::Backend::PREAD);
+  }
   read_block_metadata();
 }
 
 std::optional<std::vector<std::byte>> SST::get(std::vector<std::byte> &key) {
-  for (auto &block_metadata : block_metadata_) {
-    if (block_metadata.first_key_ == key ||
-        (block_metadata.first_key_ < key && key < block_metadata.last_key_) ||
-        block_metadata.last_key_ == key) {
-      auto block = std::move(read_block(block_metadata));
-      return block.get(key);
+  if (!may_contain(key)) {
+    return std::nullopt;
+  }
+  auto block_idx = index_.find(key);
+  if (!block_idx.has_value()) {
+    return std::nullopt;
+  }
+  return read_block(block_idx.value())->get(key);
+}
+
+std::vector<std::optional<std::vector<std::byte>>>
+SST::multi_get(std::span<const std::span<const std::byte>> keys) const {
+  std::vector<std::optional<std::vector<std::byte>>> values(keys.size());
+  // sorted keys of one block are next to each other, the block is only
+  // listed once for them
+  std::vector<size_t> block_idxs;
+  std::vector<std::pair<size_t, size_t>> key_blocks;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!filter_.may_contain(keys[i])) {
+      continue;
+    }
+    auto block_idx = index_.find(keys[i]);
+    if (!block_idx.has_value()) {
+      continue;
     }
+    if (block_idxs.empty() || block_idxs.back() != block_idx.value()) {
+      block_idxs.push_back(block_idx.value());
+    }
+    key_blocks.emplace_back(i, block_idxs.size() - 1);
+  }
+  if (block_idxs.empty()) {
+    return values;
   }
-  return std::nullopt;
+
+  auto blocks = get_blocks(block_idxs);
+  for (auto [key_idx, block_pos] : key_blocks) {
+    values[key_idx] = blocks[block_pos]->get(keys[key_idx]);
+  }
+  return values;
+}
+
+bool SST::may_contain(const std::vector<std::byte> &key) const {
+  return filter_.may_contain(key);
 }
 
-const std::vector<BlockMetadata> &SST::get_block_metadata() const {
-  return block_metadata_;
+std::vector<BlockMetadata> SST::get_block_metadata() const {
+  std::vector<BlockMetadata> block_metadata;
+  block_metadata.reserve(index_.size());
+  for (size_t block_idx = 0; block_idx < index_.size(); block_idx++) {
+    auto first_key = index_.first_key(block_idx);
+    auto last_key = index_.last_key(block_idx);
+    block_metadata.emplace_back(
+        index_.offset(block_idx), index_.block_size(block_idx),
+        std::vector<std::byte>(first_key.begin(), first_key.end()),
+        std::vector<std::byte>(last_key.begin(), last_key.end()));
+  }
+  return block_metadata;
 }
 
-Block SST::get_block(size_t block_idx) const {
-  if (block_idx > block_metadata_.size())
+const BlockIndex &SST::get_index() const { return index_; }
+
+std::shared_ptr<Block> SST::get_block(size_t block_idx) const {
+  if (block_idx >= index_.size())
     throw std::runtime_error("out of bound index");
-  return read_block(block_metadata_[block_idx]);
+  return read_block(block_idx);
 }
 
-size_t SST::number_of_block() const { return block_metadata_.size(); }
+std::vector<std::shared_ptr<Block>>
+SST::get_blocks(std::span<const size_t> block_idxs) const {
+  std::vector<std::shared_ptr<Block>> blocks(block_idxs.size());
+  std::vector<size_t> missing;
+  for (size_t i = 0; i < block_idxs.size(); i++) {
+    if (block_idxs[i] >= index_.size())
+      throw std::runtime_error("out of bound index");
+    blocks[i] = lookup_cached_block(block_idxs[i]);
+    if (!blocks[i]) {
+      missing.push_back(i);
+    }
+  }
+  if (missing.empty() || mmap_) {
+    for (auto i : missing) {
+      blocks[i] = read_block(block_idxs[i]);
+    }
+    return blocks;
+  }
+
+  std::vector<std::vector<std::byte>> buffers(missing.size());
+  std::vector<FileReader::ReadRequest> requests(missing.size());
+  for (size_t i = 0; i < missing.size(); i++) {
+    size_t block_idx = block_idxs[missing[i]];
+    buffers[i].resize(index_.block_size(block_idx));
+    requests[i] = FileReader::ReadRequest{.offset_ = index_.offset(block_idx),
+                                          .buffer_ = buffers[i]};
+  }
+  io_->read_batch(requests);
+  for (size_t i = 0; i < missing.size(); i++) {
+    blocks[missing[i]] =
+        insert_block(block_idxs[missing[i]], std::move(buffers[i]));
+  }
+  return blocks;
+}
+
+size_t SST::number_of_block() const { return index_.size(); }
 
 uint64_t SST::get_id() const { return id_; }
 
+std::vector<std::byte> SST::smallest_key() const {
+  if (index_.size() == 0) {
+    return {};
+  }
+  auto key = index_.first_key(0);
+  return std::vector<std::byte>(key.begin(), key.end());
+}
+
+std::vector<std::byte> SST::largest_key() const {
+  if (index_.size() == 0) {
+    return {};
+  }
+  auto key = index_.last_key(index_.size() - 1);
+  return std::vector<std::byte>(key.begin(), key.end());
+}
+
+SSTReadMode SST::get_read_mode() const { return read_mode_; }
+
+void SST::begin_sequential_read() const {
+  if (mmap_) {
+    mmap_->begin_sequential_read();
+  }
+}
+
+void SST::end_sequential_read() const {
+  if (mmap_) {
+    mmap_->end_sequential_read();
+  }
+}
+
 void SST::read_block_metadata() {
   std::vector<std::byte> buffer;
+  // too short to hold a footer, treated as an SST without blocks
+  if (file_size() < SST::NUMBER_OF_BLOCK_VAL_SIZE)
+    return;
   // read number of block
-  size_t number_of_block_offset =
-      io_->file_size() - SST::NUMBER_OF_BLOCK_VAL_SIZE;
+  size_t number_of_block_offset = file_size() - SST::NUMBER_OF_BLOCK_VAL_SIZE;
   uint32_t n_blocks = decode_uint64(number_of_block_offset);
   if (n_blocks == 0)
     return;
 
+  // read filter
+  size_t filter_size_offset = number_of_block_offset - FILTER_SIZE_VAL_SIZE;
+  size_t filter_offset_offset = filter_size_offset - FILTER_OFFSET_VAL_SIZE;
+  uint64_t filter_offset = decode_uint64(filter_offset_offset);
+  uint64_t filter_size = decode_uint64(filter_size_offset);
+  if (filter_size > 0) {
+    buffer.resize(filter_size);
+    read_bytes(filter_offset, filter_size, buffer);
+    filter_ = BloomFilter(std::move(buffer));
+  }
+
   // read block_metadata_offset
-  std::vector<size_t> block_metadata_offset;
-  block_metadata_offset.resize(n_blocks);
-  for (int block_id = n_blocks - 1,
-           curr_offset =
-               number_of_block_offset - BLOCK_METADATA_OFFSET_VAL_SIZE;
-       block_id >= 0;
-       block_id--, curr_offset -= BLOCK_METADATA_OFFSET_VAL_SIZE) {
-    block_metadata_offset[block_id] = decode_uint64(curr_offset);
-  }
-
-  // read block_metadata
-  block_metadata_.resize(n_blocks);
+  size_t offsets_start =
+      filter_offset_offset - n_blocks * BLOCK_METADATA_OFFSET_VAL_SIZE;
+  buffer.resize(n_blocks * BLOCK_METADATA_OFFSET_VAL_SIZE);
+  read_bytes(offsets_start, buffer.size(), buffer);
+  std::vector<uint64_t> block_metadata_offset(n_blocks);
   for (size_t block_id = 0; block_id < n_blocks; block_id++) {
-    auto curr_offset = block_metadata_offset[block_id];
-    block_metadata_[block_id].offset_ = decode_uint64(curr_offset);
+    std::span<const std::byte, 8> offset_span{
+        buffer.data() + block_id * BLOCK_METADATA_OFFSET_VAL_SIZE, 8};
+    block_metadata_offset[block_id] = decode_uint64_t(offset_span);
+  }
+
+  // read every block_metadata with one read, they are stored back to back
+  uint64_t metadata_start = block_metadata_offset[0];
+  buffer.resize(offsets_start - metadata_start);
+  read_bytes(metadata_start, buffer.size(), buffer);
+  std::span<const std::byte> metadata{buffer};
+  for (size_t block_id = 0; block_id < n_blocks; block_id++) {
+    auto entry = metadata.subspan(block_metadata_offset[block_id] -
+                                  metadata_start);
+    uint64_t offset = decode_uint64_t(entry.first<8>());
+    entry = entry.subspan(BlockMetadata::BLOCK_OFFSET_VAL_SIZE);
+    uint64_t size = decode_uint64_t(entry.first<8>());
+    entry = entry.subspan(BlockMetadata::BLOCK_SIZE_VAL_SIZE);
 
-    curr_offset += BlockMetadata::BLOCK_OFFSET_VAL_SIZE;
-    block_metadata_[block_id].size_ = decode_uint64(curr_offset);
+    std::span<const std::byte, 2> first_key_len_span = entry.first<2>();
+    uint16_t first_key_len = decode_uint16_t(first_key_len_span);
+    entry = entry.subspan(BlockMetadata::BLOCK_FIRST_KEY_LEN_VAL_SIZE);
+    auto first_key = entry.first(first_key_len);
+    entry = entry.subspan(first_key_len);
 
-    curr_offset += BlockMetadata::BLOCK_SIZE_VAL_SIZE;
-    block_metadata_[block_id].first_key_ =
-        std::move(decode_var_string(curr_offset));
+    std::span<const std::byte, 2> last_key_len_span = entry.first<2>();
+    uint16_t last_key_len = decode_uint16_t(last_key_len_span);
+    entry = entry.subspan(BlockMetadata::BLOCK_LAST_KEY_LEN_VAL_SIZE);
+    auto last_key = entry.first(last_key_len);
 
-    curr_offset += BlockMetadata::BLOCK_FIRST_KEY_LEN_VAL_SIZE +
-                   block_metadata_[block_id].first_key_.size();
-    block_metadata_[block_id].last_key_ =
-        std::move(decode_var_string(curr_offset));
+    index_.add(offset, size, first_key, last_key);
   }
+  index_.shrink_to_fit();
 }
 
-Block SST::read_block(const BlockMetadata &block_metadata) const {
+std::shared_ptr<Block> SST::read_block(size_t block_idx) const {
+  if (mmap_) {
+    auto bytes = mmap_->data().subspan(index_.offset(block_idx),
+                                       index_.block_size(block_idx));
+    return std::make_shared<Block>(Block::decode(bytes, mmap_));
+  }
+
+  auto cached = lookup_cached_block(block_idx);
+  if (cached) {
+    return cached;
+  }
+
   std::vector<std::byte> buffer;
-  buffer.resize(block_metadata.size_);
-  io_->read(block_metadata.offset_, block_metadata.size_, buffer);
-  Block block = Block::decode(std::move(buffer));
+  buffer.resize(index_.block_size(block_idx));
+  io_->read(index_.offset(block_idx), buffer.size(), buffer);
+  return insert_block(block_idx, std::move(buffer));
+}
+
+std::shared_ptr<Block> SST::lookup_cached_block(size_t block_idx) const {
+  if (!block_cache_) {
+    return nullptr;
+  }
+  BlockCacheKey cache_key{.sst_id_ = id_, .offset_ = index_.offset(block_idx)};
+  return block_cache_->lookup(cache_key).value_or(nullptr);
+}
+
+std::shared_ptr<Block> SST::insert_block(size_t block_idx,
+                                         std::vector<std::byte> buffer) const {
+  auto block = std::make_shared<Block>(Block::decode(std::move(buffer)));
+  if (block_cache_) {
+    BlockCacheKey cache_key{.sst_id_ = id_,
+                            .offset_ = index_.offset(block_idx)};
+    block_cache_->insert(cache_key, block, block->memory_usage());
+  }
   return block;
 }
 
+void SST::read_bytes(size_t offset, size_t length,
+                     std::vector<std::byte> &buffer) const {
+  if (!mmap_) {
+    io_->read(offset, length, buffer);
+    return;
+  }
+  if (offset + length > mmap_->file_size()) {
+    throw std::runtime_error("read past the end of the SST");
+  }
+  auto bytes = mmap_->data().subspan(offset, length);
+  std::copy(bytes.begin(), bytes.end(), buffer.begin());
+}
+
+uint64_t SST::file_size() const {
+  return mmap_ ? mmap_->file_size() : io_->file_size();
+}
+
 // TODO: make this func as template
 uint64_t SST::decode_uint64(size_t offset) {
   std::vector<std::byte> buffer;
   // read number of block
   buffer.resize(8);
-  io_->read(offset, 8, buffer);
+  read_bytes(offset, 8, buffer);
 
   std::span<const std::byte, 8> buffer_span{buffer.data(), buffer.size()};
   return decode_uint64_t(buffer_span);
 }
 
-std::vector<std::byte> SST::decode_var_string(size_t offset) {
-  std::vector<std::byte> buffer;
-  buffer.resize(2);
-  io_->read(offset, 2, buffer);
-  std::span<const std::byte, 2> buffer_span{buffer.data(), buffer.size()};
-
-  offset += 2;
-  auto string_len = decode_uint16_t(buffer_span);
-  buffer.resize(string_len);
-  io_->read(offset, string_len, buffer);
-  return buffer;
-}
-
 uint64_t SST::parse_id_from_file_name(const std::filesystem::path &file_name) {
   const auto filename = file_name.filename().string();
   auto parts = filename | std::views::split('_');
@@ -1,31 +1,40 @@
 #include "sst/sst_builder.hpp"
 #include "sst/block.hpp"
+#include "sst/bloom_filter.hpp"
 #include "sst/sst.hpp"
 #include "sst/sst_builder.hpp"
 #include "utils.hpp"
 
 SSTBuilder::SSTBuilder(const std::filesystem::path &path, SSTConfig &sst_config)
-    : finished_(false), sst_config_(sst_config), path_(path) {
+    : finished_(false), sst_config_(sst_config),
+      block_builder_(sst_config.restart_interval_), filter_offset_(0),
+      filter_size_(0), path_(path) {
   out_ = std::ofstream(path, std::ios::binary);
 }
 
-void SSTBuilder::add_entry(std::vector<std::byte> &key,
-                           std::vector<std::byte> &val) {
+void SSTBuilder::add_entry(std::span<const std::byte> key,
+                           std::span<const std::byte> val) {
   if (finished_) {
     throw std::runtime_error("SSTBuilder build finished");
   }
 
-  if (2 + key.size() + 2 + val.size() + block_builder_.get_size() >
+  // upper bound, the key may share a prefix with the previous one
+  if (Block::EntryHeaderSize + key.size() + val.size() + Block::OffsetSize +
+          block_builder_.get_size() >
       sst_config_.block_size_) {
     write_block();
   }
   block_builder_.add_entry(key, val);
+  if (sst_config_.bloom_bits_per_key_ > 0) {
+    key_hashes_.push_back(BloomFilter::hash(key));
+  }
 }
 
 SST SSTBuilder::build() {
   if (block_builder_.get_size() > 0) {
     write_block();
   }
+  write_filter();
 
   std::vector<uint64_t> block_metadata_offsets;
   block_metadata_offsets.reserve(block_metadata_.size());
@@ -48,6 +57,14 @@ SST SSTBuilder::build() {
                encoded_offset.size());
   }
 
+  // write filter location
+  auto encoded_filter_offset = encode_uint64_t(filter_offset_);
+  out_.write(reinterpret_cast<char *>(encoded_filter_offset.data()),
+             encoded_filter_offset.size());
+  auto encoded_filter_size = encode_uint64_t(filter_size_);
+  out_.write(reinterpret_cast<char *>(encoded_filter_size.data()),
+             encoded_filter_size.size());
+
   // write number of block
   auto encoded_num_block_val = encode_uint64_t(block_metadata_.size());
   out_.write(reinterpret_cast<char *>(encoded_num_block_val.data()),
@@ -57,7 +74,15 @@ SST SSTBuilder::build() {
   out_.close();
 
   // TODO: consider copying the block_metadata to avoid reading?
-  return SST(path_);
+  return SST(path_, sst_config_.block_cache_, sst_config_.read_mode_);
+}
+
+uint64_t SSTBuilder::estimated_size() const {
+  uint64_t size = block_builder_.get_size();
+  if (!block_metadata_.empty()) {
+    size += block_metadata_.back().offset_ + block_metadata_.back().size_;
+  }
+  return size;
 }
 
 const std::vector<BlockMetadata> &SSTBuilder::get_block_metadata() const {
@@ -72,5 +97,14 @@ void SSTBuilder::write_block() {
              encoded_block.size());
   block_metadata_.emplace_back(offset, encoded_block.size(),
                                block.get_first_key(), block.get_last_key());
-  block_builder_ = BlockBuilder();
+  block_builder_ = BlockBuilder(sst_config_.restart_interval_);
+}
+
+void SSTBuilder::write_filter() {
+  auto filter =
+      BloomFilter::build(key_hashes_, sst_config_.bloom_bits_per_key_);
+  filter_offset_ = static_cast<uint64_t>(out_.tellp());
+  filter_size_ = filter.size();
+  out_.write(reinterpret_cast<char *>(filter.data()), filter.size());
+  key_hashes_.clear();
 }
@@ -5,35 +5,74 @@
 #include <memory>
 
 SSTIterator::SSTIterator(std::shared_ptr<SST> sst_ptr)
-    : sst_ptr_(sst_ptr), block_idx_(0),
-      curr_block_iterator_(std::make_shared<Block>(sst_ptr->get_block(0))) {
-  curr_entry.key_ = curr_block_iterator_.key();
-  curr_entry.val_ = curr_block_iterator_.value();
+    : sst_ptr_(sst_ptr), block_idx_(0), readahead_idx_(0),
+      curr_block_iterator_(load_block()) {
+  sst_ptr_->begin_sequential_read();
+  skip_empty_blocks();
 }
 
+SSTIterator::~SSTIterator() { sst_ptr_->end_sequential_read(); }
+
 void SSTIterator::next() {
   if (!is_valid()) {
     return;
   }
 
   curr_block_iterator_.next();
+  skip_empty_blocks();
+}
 
-  if (!curr_block_iterator_.is_valid()) {
-    block_idx_++;
-    if (!is_valid())
-      return;
-    curr_block_iterator_ =
-        BlockIterator(std::make_shared<Block>(sst_ptr_->get_block(block_idx_)));
-  }
-
-  curr_entry.key_ = curr_block_iterator_.key();
-  curr_entry.val_ = curr_block_iterator_.value();
+void SSTIterator::seek(const std::vector<std::byte> &target) {
+  // the first block whose last key is >= target holds the entry, if any
+  block_idx_ = sst_ptr_->get_index().lower_bound(target);
+  curr_block_iterator_ = BlockIterator(load_block());
+  curr_block_iterator_.seek(target);
+  skip_empty_blocks();
 }
 
-std::vector<std::byte> SSTIterator::key() { return curr_entry.key_; }
+std::span<const std::byte> SSTIterator::key_view() {
+  return curr_block_iterator_.key_view();
+}
 
-std::vector<std::byte> SSTIterator::value() { return curr_entry.val_; }
+std::span<const std::byte> SSTIterator::value_view() {
+  return curr_block_iterator_.value_view();
+}
 
 bool SSTIterator::is_valid() {
   return (block_idx_ < sst_ptr_->number_of_block());
 }
+
+std::shared_ptr<Block> SSTIterator::load_block() {
+  if (!is_valid()) {
+    return std::make_shared<Block>();
+  }
+  bool sequential = prev_block_idx_ && *prev_block_idx_ + 1 == block_idx_;
+  prev_block_idx_ = block_idx_;
+  if (block_idx_ >= readahead_idx_ &&
+      block_idx_ - readahead_idx_ < readahead_.size()) {
+    return readahead_[block_idx_ - readahead_idx_];
+  }
+  readahead_.clear();
+  if (!sequential || sst_ptr_->get_read_mode() != SSTReadMode::IO_URING) {
+    return sst_ptr_->get_block(block_idx_);
+  }
+
+  size_t end = block_idx_ + READAHEAD_BLOCKS;
+  if (end > sst_ptr_->number_of_block()) {
+    end = sst_ptr_->number_of_block();
+  }
+  std::vector<size_t> block_idxs;
+  for (size_t idx = block_idx_; idx < end; idx++) {
+    block_idxs.push_back(idx);
+  }
+  readahead_ = sst_ptr_->get_blocks(block_idxs);
+  readahead_idx_ = block_idx_;
+  return readahead_.front();
+}
+
+void SSTIterator::skip_empty_blocks() {
+  while (is_valid() && !curr_block_iterator_.is_valid()) {
+    block_idx_++;
+    curr_block_iterator_ = BlockIterator(load_block());
+  }
+}
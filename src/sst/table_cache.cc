@@ -0,0 +1,72 @@
+#include "sst/table_cache.hpp"
+#include "utils.hpp"
+#include <algorithm>
+
+namespace {
+// keeps a few dozen SSTs per shard so that small capacities are not split
+// into shards too small to hold anything
+size_t shard_count(size_t capacity) {
+  size_t max_shards = ShardedLRUCache<uint64_t, int>::DEFAULT_SHARDS;
+  return std::clamp<size_t>(capacity / 64, 1, max_shards);
+}
+} // namespace
+
+SSTHandle SSTHandle::from_sst(const SST &sst) {
+  return SSTHandle{.id_ = sst.get_id(),
+                   .smallest_key_ = sst.smallest_key(),
+                   .largest_key_ = sst.largest_key(),
+                   .file_size_ = sst.file_size()};
+}
+
+bool SSTHandle::may_contain(std::span<const std::byte> key) const {
+  return compare_bytes(key, smallest_key_) >= 0 &&
+         compare_bytes(key, largest_key_) <= 0;
+}
+
+bool SSTHandle::overlaps(std::span<const std::byte> lower,
+                         std::span<const std::byte> upper) const {
+  if (compare_bytes(largest_key_, lower) < 0) {
+    return false;
+  }
+  return upper.empty() || compare_bytes(smallest_key_, upper) < 0;
+}
+
+TableCache::TableCache(std::filesystem::path sst_directory, size_t capacity,
+                       std::shared_ptr<BlockCache> block_cache,
+                       SSTReadMode read_mode)
+    : sst_directory_(std::move(sst_directory)),
+      block_cache_(std::move(block_cache)), read_mode_(read_mode),
+      cache_(capacity, shard_count(capacity)) {}
+
+std::shared_ptr<SST> TableCache::get(uint64_t sst_id) {
+  auto cached = cache_.lookup(sst_id);
+  if (cached.has_value()) {
+    return std::move(cached.value());
+  }
+
+  // concurrent misses may both open the SST, the last insert wins
+  auto sst = std::make_shared<SST>(sst_path(sst_id), block_cache_, read_mode_);
+  cache_.insert(sst_id, sst, 1);
+  return sst;
+}
+
+std::shared_ptr<SST> TableCache::open_uncached(uint64_t sst_id) const {
+  return std::make_shared<SST>(sst_path(sst_id), nullptr, read_mode_);
+}
+
+void TableCache::insert(std::shared_ptr<SST> sst) {
+  auto sst_id = sst->get_id();
+  cache_.insert(sst_id, std::move(sst), 1);
+}
+
+void TableCache::evict(uint64_t sst_id) { cache_.erase(sst_id); }
+
+std::filesystem::path TableCache::sst_path(uint64_t sst_id) const {
+  return sst_directory_ / ("sst_" + std::to_string(sst_id));
+}
+
+size_t TableCache::size() { return cache_.usage(); }
+
+uint64_t TableCache::hits() const { return cache_.hits(); }
+
+uint64_t TableCache::misses() const { return cache_.misses(); }
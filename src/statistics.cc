@@ -0,0 +1,60 @@
+#include "statistics.hpp"
+
+void Statistics::record_flush(std::chrono::microseconds lag) {
+  uint64_t lag_us = lag.count() > 0 ? lag.count() : 0;
+  flush_count_.fetch_add(1, std::memory_order_relaxed);
+  flush_lag_total_us_.fetch_add(lag_us, std::memory_order_relaxed);
+  update_max(flush_lag_max_us_, lag_us);
+}
+
+void Statistics::record_flush_write(uint64_t bytes_written) {
+  flush_bytes_written_.fetch_add(bytes_written, std::memory_order_relaxed);
+}
+
+void Statistics::record_write_delay(std::chrono::microseconds delay) {
+  write_delay_count_.fetch_add(1, std::memory_order_relaxed);
+  write_delay_total_us_.fetch_add(delay.count(), std::memory_order_relaxed);
+}
+
+void Statistics::record_write_stop(std::chrono::microseconds duration) {
+  write_stop_count_.fetch_add(1, std::memory_order_relaxed);
+  write_stop_total_us_.fetch_add(duration.count(), std::memory_order_relaxed);
+}
+
+void Statistics::record_compaction(uint64_t bytes_read,
+                                   uint64_t bytes_written) {
+  compaction_count_.fetch_add(1, std::memory_order_relaxed);
+  compaction_bytes_read_.fetch_add(bytes_read, std::memory_order_relaxed);
+  compaction_bytes_written_.fetch_add(bytes_written,
+                                      std::memory_order_relaxed);
+}
+
+StorageStats Statistics::snapshot() const {
+  StorageStats stats;
+  stats.flush_count_ = flush_count_.load(std::memory_order_relaxed);
+  stats.flush_bytes_written_ =
+      flush_bytes_written_.load(std::memory_order_relaxed);
+  stats.flush_lag_total_ = std::chrono::microseconds(
+      flush_lag_total_us_.load(std::memory_order_relaxed));
+  stats.flush_lag_max_ = std::chrono::microseconds(
+      flush_lag_max_us_.load(std::memory_order_relaxed));
+  stats.write_delay_count_ = write_delay_count_.load(std::memory_order_relaxed);
+  stats.write_delay_total_ = std::chrono::microseconds(
+      write_delay_total_us_.load(std::memory_order_relaxed));
+  stats.write_stop_count_ = write_stop_count_.load(std::memory_order_relaxed);
+  stats.write_stop_total_ = std::chrono::microseconds(
+      write_stop_total_us_.load(std::memory_order_relaxed));
+  stats.compaction_count_ = compaction_count_.load(std::memory_order_relaxed);
+  stats.compaction_bytes_read_ =
+      compaction_bytes_read_.load(std::memory_order_relaxed);
+  stats.compaction_bytes_written_ =
+      compaction_bytes_written_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void Statistics::update_max(std::atomic<uint64_t> &max, uint64_t val) {
+  uint64_t curr = max.load(std::memory_order_relaxed);
+  while (curr < val &&
+         !max.compare_exchange_weak(curr, val, std::memory_order_relaxed)) {
+  }
+}
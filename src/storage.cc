@@ -1,13 +1,19 @@
 #include "storage.hpp"
+#include "io/file_writer.hpp"
 #include "memtable.hpp"
+#include "merge_iterator.hpp"
+#include "sst/level_iterator.hpp"
 #include "sst/sst_builder.hpp"
+#include "sst/sst_iterator.hpp"
 #include "utils.hpp"
 #include "version_edit.hpp"
 #include <algorithm>
 #include <chrono>
-#include <format>
+#include <iterator>
+#include <map>
 #include <mutex>
-#include <string_view>
+#include <numeric>
+#include <set>
 
 Storage::Storage(StorageOption opt)
     : opt_(std::move(opt)), latest_table_id_(0), active_memtable_(nullptr),
@@ -16,35 +22,217 @@ Storage::Storage(StorageOption opt)
     std::filesystem::create_directories(opt_.sst_directory_);
   }
 
-  auto [manifest, manifest_records] = Manifest::recover(opt_.manifest_path_);
+  if (opt_.block_cache_size_ > 0) {
+    block_cache_ = std::make_shared<BlockCache>(opt_.block_cache_size_);
+  }
+  table_cache_ = std::make_shared<TableCache>(
+      opt_.sst_directory_, opt_.table_cache_capacity_, block_cache_,
+      opt_.sst_read_mode_);
+  levels_.resize(std::max<uint64_t>(opt_.num_levels_, 1));
+  compaction_picker_ = CompactionPicker::create(CompactionOptions{
+      .style_ = opt_.compaction_style_,
+      .num_levels_ = opt_.num_levels_,
+      .level0_file_num_compaction_trigger_ =
+          opt_.level0_file_num_compaction_trigger_,
+      .max_bytes_for_level_base_ = opt_.max_bytes_for_level_base_,
+      .max_bytes_for_level_multiplier_ = opt_.max_bytes_for_level_multiplier_,
+      .target_file_size_ = opt_.target_file_size_,
+      .max_size_amplification_percent_ =
+          opt_.max_size_amplification_percent_,
+      .size_ratio_ = opt_.size_ratio_,
+      .min_merge_width_ = opt_.min_merge_width_});
+
+  auto [manifest, manifest_records] =
+      Manifest::recover(opt_.manifest_directory_);
   manifest_ = std::move(manifest);
   recover(manifest_records);
 
   new_active_memtable();
+  install_super_version();
+  write_controller_ = WriteController{WriteControllerConfig{
+      .immutable_memtable_soft_limit_ = opt_.immutable_memtable_soft_limit_,
+      .immutable_memtable_hard_limit_ = opt_.immutable_memtable_hard_limit_,
+      .pending_bytes_soft_limit_ = opt_.pending_bytes_soft_limit_,
+      .pending_bytes_hard_limit_ = opt_.pending_bytes_hard_limit_,
+      .l0_sst_soft_limit_ = opt_.l0_sst_soft_limit_,
+      .l0_sst_hard_limit_ = opt_.l0_sst_hard_limit_,
+      .max_delay_ = opt_.max_write_delay_}};
+  flush_pool_ = std::make_unique<ThreadPool>(opt_.max_background_flushes);
+  if (opt_.max_subcompactions_ > 1) {
+    compaction_pool_ = std::make_unique<ThreadPool>(opt_.max_subcompactions_);
+  }
   stopped_.store(false, std::memory_order_relaxed);
   flush_thread_ = std::thread([this]() { this->flush_thread(); });
+  compaction_thread_ = std::thread([this]() { this->compaction_thread(); });
+  // the recovered WALs may hold more immutable memtables than
+  // max_number_of_memtable_ keeps in memory
+  if (immutable_memtable_.size() > opt_.max_number_of_memtable_) {
+    schedule_flush();
+  }
+  // the recovered levels may already need a compaction
+  schedule_compaction();
 };
 
 void Storage::put(std::vector<std::byte> &key, std::vector<std::byte> &value) {
+  WriteBatch batch;
+  batch.put(key, value);
+  write(batch);
+}
+
+void Storage::write(WriteBatch &batch) {
+  if (batch.count() == 0) {
+    return;
+  }
+
+  Writer writer;
+  writer.batch_ = &batch;
+
+  std::unique_lock wlk{write_mu_};
+  // checked under write_mu_, close() freezes the active memtable once the
+  // writers queued before stopped_ was set are done
   if (stopped_.load(std::memory_order_acquire)) {
     throw std::runtime_error("storage stopped");
   }
+  writers_.push_back(&writer);
+  writer.cv_.wait(wlk, [&writer, this]() {
+    return writer.done_ || writers_.front() == &writer;
+  });
+  if (writer.done_) {
+    if (writer.error_) {
+      std::rethrow_exception(writer.error_);
+    }
+    return;
+  }
 
-  uint64_t record_size = key.size() + value.size();
-  std::lock_guard lk{mu_};
-  if (record_size + active_memtable_->size() > opt_.mem_table_size_) {
-    active_memtable_->freeze();
-    immutable_memtable_.push_back(std::move(active_memtable_));
-    new_active_memtable();
+  // leader: take every queued writer up to MAX_WRITE_GROUP_SIZE bytes
+  std::vector<Writer *> group;
+  uint64_t group_size = 0;
+  for (auto *w : writers_) {
+    uint64_t batch_size = w->batch_->byte_size();
+    if (!group.empty() && group_size + batch_size > MAX_WRITE_GROUP_SIZE) {
+      break;
+    }
+    group.push_back(w);
+    group_size += batch_size;
   }
 
+  // new writers keep queueing behind the group while it is committed
+  wlk.unlock();
+  std::exception_ptr error;
+  try {
+    write_group(group, group_size);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  wlk.lock();
+
+  for (auto *w : group) {
+    writers_.pop_front();
+    if (w != &writer) {
+      w->error_ = error;
+      w->done_ = true;
+      w->cv_.notify_one();
+    }
+  }
+  if (!writers_.empty()) {
+    writers_.front()->cv_.notify_one();
+  } else {
+    writers_drained_cv_.notify_all();
+  }
+  wlk.unlock();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void Storage::write_group(std::vector<Writer *> &group, uint64_t group_size) {
+  {
+    std::unique_lock lk{mu_};
+    throttle_write(lk);
+    make_room_for_write(group_size);
+  }
+
+  std::vector<const WriteBatch *> batches;
+  batches.reserve(group.size());
+  for (auto *w : group) {
+    batches.push_back(w->batch_);
+  }
+
+  // Only the leader replaces active_memtable_ and active_wal_, so both are
+  // stable here without holding mu_. Readers can run concurrently with the
+  // memtable inserts.
   if (opt_.wal_sync_option == WALSyncOption::SYNC_ON_WRITE) {
-    active_wal_->add_record_and_sync({.key_ = key, .value_ = value});
+    active_wal_->add_batches_and_sync(batches);
   } else {
-    active_wal_->add_record({.key_ = key, .value_ = value});
+    active_wal_->add_batches(batches);
+  }
+
+  // the whole group shares one sequence number, readers see none of its
+  // entries until it is published below
+  uint64_t sequence = last_sequence_.load(std::memory_order_relaxed) + 1;
+  for (auto *batch : batches) {
+    for (auto &record : batch->records()) {
+      active_memtable_->put(record.key_, record.value_, sequence);
+    }
+  }
+  last_sequence_.store(sequence, std::memory_order_release);
+}
+
+void Storage::throttle_write(std::unique_lock<std::shared_mutex> &lk) {
+  auto pressure = get_write_pressure();
+  if (write_controller_.get_stall(pressure) == WriteStall::DELAYED) {
+    // sleep once per write group, without holding mu_ so that readers and the
+    // flush keep going
+    auto delay = write_controller_.get_delay(pressure);
+    lk.unlock();
+    std::this_thread::sleep_for(delay);
+    lk.lock();
+    stats_.record_write_delay(delay);
+  }
+
+  if (write_controller_.get_stall(get_write_pressure()) !=
+      WriteStall::STOPPED) {
+    return;
+  }
+  // max_number_of_memtable_ may keep enough memtables in memory to stay at
+  // the hard limit, flush all of them to unblock the write. Level 0 shrinks
+  // through compaction.
+  schedule_flush(true);
+  schedule_compaction();
+  auto stop_start = std::chrono::steady_clock::now();
+  stall_cv_.wait(lk, [this]() {
+    return stopped_.load(std::memory_order_acquire) ||
+           write_controller_.get_stall(get_write_pressure()) !=
+               WriteStall::STOPPED;
+  });
+  stats_.record_write_stop(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - stop_start));
+  if (stopped_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("storage stopped");
   }
+}
 
-  active_memtable_->put(key, value);
+WritePressure Storage::get_write_pressure() const {
+  WritePressure pressure{.immutable_memtables_ = immutable_memtable_.size(),
+                         .l0_ssts_ = levels_[0].size()};
+  for (auto &mem_table : immutable_memtable_) {
+    pressure.pending_bytes_ += mem_table->size();
+  }
+  return pressure;
+}
+
+void Storage::make_room_for_write(uint64_t write_size) {
+  if (write_size + active_memtable_->size() > opt_.mem_table_size_) {
+    active_memtable_->freeze();
+    immutable_memtable_.push_back(std::move(active_memtable_));
+    new_active_memtable();
+    install_super_version();
+    if (immutable_memtable_.size() > opt_.max_number_of_memtable_) {
+      schedule_flush();
+    }
+  }
 }
 
 std::optional<std::vector<std::byte>>
@@ -53,9 +241,10 @@ Storage::get(std::vector<std::byte> &key) {
     throw std::runtime_error("storage stopped");
   }
 
-  std::shared_lock lk{mu_};
+  auto sequence = last_sequence_.load(std::memory_order_acquire);
+  auto version = super_version_.load(std::memory_order_acquire);
   std::optional<std::vector<std::byte>> value_slice;
-  value_slice = active_memtable_->get(key);
+  value_slice = version->active_memtable_->get(key, sequence);
   if (value_slice.has_value()) {
     if (value_slice.value().size() > 0) {
       return value_slice;
@@ -63,7 +252,8 @@ Storage::get(std::vector<std::byte> &key) {
     return std::nullopt;
   }
 
-  for (auto it = immutable_memtable_.rbegin(); it != immutable_memtable_.rend();
+  auto &immutable_memtable = version->immutable_memtable_;
+  for (auto it = immutable_memtable.rbegin(); it != immutable_memtable.rend();
        it = std::next(it)) {
     value_slice = (*it)->get(key);
     if (value_slice == std::nullopt)
@@ -74,86 +264,332 @@ Storage::get(std::vector<std::byte> &key) {
     return std::nullopt;
   }
 
-  for (auto it = sst_.rbegin(); it != sst_.rend(); ++it) {
-    value_slice = (*it)->get(key);
-    if (value_slice == std::nullopt)
+  // level 0 newest first, then at most one SST per deeper level. The key
+  // range rules most SSTs out without opening them.
+  auto &level0 = version->levels_[0];
+  for (auto it = level0.rbegin(); it != level0.rend(); ++it) {
+    if (!(*it)->may_contain(key))
       continue;
-    if (value_slice.value().size() > 0) {
-      return value_slice;
+    value_slice = table_cache_->get((*it)->id_)->get(key);
+    if (value_slice.has_value())
+      break;
+  }
+  for (size_t level = 1;
+       !value_slice.has_value() && level < version->levels_.size(); level++) {
+    auto &files = version->levels_[level];
+    size_t file_idx = find_file(files, key);
+    if (file_idx < files.size()) {
+      value_slice = table_cache_->get(files[file_idx]->id_)->get(key);
     }
-    return std::nullopt;
+  }
+  if (value_slice.has_value() && value_slice.value().size() > 0) {
+    return value_slice;
   }
   return std::nullopt;
 }
 
-void Storage::remove(std::vector<std::byte> &key) { put(key, TOMBSTONE); }
+std::vector<std::optional<std::vector<std::byte>>>
+Storage::multi_get(std::span<const std::vector<std::byte>> keys) {
+  if (stopped_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("storage stopped");
+  }
+
+  auto sequence = last_sequence_.load(std::memory_order_acquire);
+  auto version = super_version_.load(std::memory_order_acquire);
+  std::vector<std::optional<std::vector<std::byte>>> values(keys.size());
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::sort(order, [&](size_t lhs, size_t rhs) {
+    return compare_bytes(keys[lhs], keys[rhs]) < 0;
+  });
+
+  // indexes of the distinct keys not found yet, in key order. A found value
+  // may be empty, a tombstone that hides the older tables.
+  std::vector<size_t> pending;
+  for (auto i : order) {
+    if (pending.empty() || compare_bytes(keys[pending.back()], keys[i]) != 0) {
+      pending.push_back(i);
+    }
+  }
+  auto drop_found = [&]() {
+    std::erase_if(pending, [&](size_t i) { return values[i].has_value(); });
+  };
+
+  for (auto i : pending) {
+    values[i] = version->active_memtable_->get(keys[i], sequence);
+  }
+  drop_found();
+  auto &immutable_memtable = version->immutable_memtable_;
+  for (auto it = immutable_memtable.rbegin();
+       it != immutable_memtable.rend() && !pending.empty(); ++it) {
+    for (auto i : pending) {
+      values[i] = (*it)->get(keys[i]);
+    }
+    drop_found();
+  }
+
+  // newest first, level 0 and then the deeper levels
+  std::vector<const SSTHandle *> tables;
+  auto &level0 = version->levels_[0];
+  for (auto it = level0.rbegin(); it != level0.rend(); ++it) {
+    tables.push_back(it->get());
+  }
+  for (size_t level = 1; level < version->levels_.size(); level++) {
+    for (auto &file : version->levels_[level]) {
+      tables.push_back(file.get());
+    }
+  }
+
+  std::vector<std::span<const std::byte>> candidate_keys;
+  for (auto *table : tables) {
+    if (pending.empty()) {
+      break;
+    }
+    // the pending keys within the key range of the SST, both are sorted
+    auto first = std::partition_point(
+        pending.begin(), pending.end(), [&](size_t i) {
+          return compare_bytes(keys[i], table->smallest_key_) < 0;
+        });
+    auto last = std::partition_point(first, pending.end(), [&](size_t i) {
+      return compare_bytes(keys[i], table->largest_key_) <= 0;
+    });
+    if (first == last) {
+      continue;
+    }
+    candidate_keys.clear();
+    for (auto it = first; it != last; ++it) {
+      candidate_keys.push_back(keys[*it]);
+    }
+    auto found = table_cache_->get(table->id_)->multi_get(candidate_keys);
+    for (size_t j = 0; j < found.size(); j++) {
+      values[*(first + j)] = std::move(found[j]);
+    }
+    drop_found();
+  }
+
+  for (auto &value : values) {
+    if (value.has_value() && value.value().empty()) {
+      value.reset();
+    }
+  }
+  // duplicated keys take the value of the first one in key order
+  for (size_t pos = 1; pos < order.size(); pos++) {
+    if (compare_bytes(keys[order[pos - 1]], keys[order[pos]]) == 0) {
+      values[order[pos]] = values[order[pos - 1]];
+    }
+  }
+  return values;
+}
+
+StorageIterator Storage::scan(const std::vector<std::byte> &lower,
+                              const std::vector<std::byte> &upper) {
+  if (stopped_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("storage stopped");
+  }
+
+  // children newest first, the merge keeps the newest version of a key
+  auto sequence = last_sequence_.load(std::memory_order_acquire);
+  auto version = super_version_.load(std::memory_order_acquire);
+  std::vector<std::unique_ptr<Iterator>> children;
+  children.reserve(1 + version->immutable_memtable_.size() +
+                   version->levels_[0].size());
+  children.push_back(version->active_memtable_->new_scan_iterator(sequence));
+  for (auto it = version->immutable_memtable_.rbegin();
+       it != version->immutable_memtable_.rend(); ++it) {
+    children.push_back((*it)->new_scan_iterator());
+  }
+  // level 0 SSTs overlap, each one is merged on its own
+  auto &level0 = version->levels_[0];
+  for (auto it = level0.rbegin(); it != level0.rend(); ++it) {
+    if ((*it)->overlaps(lower, upper)) {
+      children.push_back(
+          std::make_unique<SSTIterator>(table_cache_->get((*it)->id_)));
+    }
+  }
+  // the SSTs of a deeper level never overlap, one LevelIterator opens them
+  // one after the other
+  for (size_t level = 1; level < version->levels_.size(); level++) {
+    LevelFiles files;
+    std::ranges::copy_if(
+        version->levels_[level], std::back_inserter(files),
+        [&](auto &file) { return file->overlaps(lower, upper); });
+    if (!files.empty()) {
+      children.push_back(
+          std::make_unique<LevelIterator>(table_cache_, std::move(files)));
+    }
+  }
+
+  auto iter = std::make_unique<MergeIterator>(std::move(children));
+  iter->seek(lower);
+  return StorageIterator(std::move(iter), upper);
+}
+
+void Storage::remove(std::vector<std::byte> &key) {
+  WriteBatch batch;
+  batch.remove(key);
+  write(batch);
+}
 
-std::vector<std::unique_ptr<SST>>
+SSTConfig Storage::make_sst_config() const {
+  return SSTConfig{.block_size_ = opt_.max_sst_block_size_,
+                   .sst_directory_ = opt_.sst_directory_,
+                   .bloom_bits_per_key_ = opt_.bloom_bits_per_key_,
+                   .block_cache_ = block_cache_,
+                   .restart_interval_ = opt_.block_restart_interval_,
+                   .read_mode_ = opt_.sst_read_mode_};
+}
+
+std::vector<std::shared_ptr<SST>>
 Storage::flush_to_SST(std::vector<std::shared_ptr<MemTable>> &mem_table_ptr) {
-  std::vector<std::unique_ptr<SST>> new_sst;
-  SSTConfig sst_config{.block_size_ = opt_.max_sst_block_size_,
-                       .sst_directory_ = opt_.sst_directory_};
+  auto sst_config = make_sst_config();
+  std::vector<std::future<SST>> pending;
+  pending.reserve(mem_table_ptr.size());
   for (auto &mem_table : mem_table_ptr) {
-    new_sst.emplace_back(std::make_unique<SST>(mem_table->flush(sst_config)));
+    pending.emplace_back(flush_pool_->submit([mem_table, sst_config]() mutable {
+      return mem_table->flush(sst_config);
+    }));
+  }
+
+  // collect in submission order so new_sst keeps the memtable order, oldest
+  // first, whatever order the flushes finish in.
+  std::vector<std::shared_ptr<SST>> new_sst;
+  std::exception_ptr error;
+  for (auto &future : pending) {
+    try {
+      new_sst.emplace_back(std::make_shared<SST>(future.get()));
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
   }
   return new_sst;
 }
 
 void Storage::flush_thread() {
-  while (!stopped_.load(std::memory_order_acquire)) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    flush_run(false);
+  while (true) {
+    bool flush_all = false;
+    {
+      std::unique_lock lk{flush_mu_};
+      flush_cv_.wait(lk, [this]() {
+        return flush_pending_ || stopped_.load(std::memory_order_acquire);
+      });
+      if (stopped_.load(std::memory_order_acquire)) {
+        return;
+      }
+      flush_all = flush_all_pending_;
+      flush_pending_ = false;
+      flush_all_pending_ = false;
+    }
+    flush_run(flush_all);
   }
 }
 
-void Storage::recover(const std::vector<VersionEdit> &manifest_records) {
-  auto sst_pattern = opt_.sst_directory_ / "sst_{}";
-  auto sst_pattern_view = sst_pattern.string();
-
-  auto wal_pattern = opt_.wal_directory_ / "{}.wal";
-  auto wal_pattern_view = wal_pattern.string();
+void Storage::schedule_flush(bool flush_all) {
+  {
+    std::lock_guard lk{flush_mu_};
+    flush_pending_ = true;
+    flush_all_pending_ = flush_all_pending_ || flush_all;
+  }
+  flush_cv_.notify_one();
+}
 
+void Storage::recover(const std::vector<VersionEdit> &manifest_records) {
   if (manifest_records.empty()) {
     latest_table_id_ = 0;
     return;
   }
 
   std::vector<uint64_t> wal;
-  std::map<uint64_t, std::vector<uint64_t>> leveled;
-  uint64_t min_recover_wal_id = 0;
+  // every WAL below it is flushed
+  uint64_t log_number = 0;
+  // per level, the live SSTs by id. Level 0 SSTs are flushed in id order.
+  std::vector<std::map<uint64_t, NewFileMetadata>> leveled;
+  uint64_t next_file_id = 0;
   for (const auto &record : manifest_records) {
     if (record.get_wal_addition().has_value()) {
       wal.emplace_back(record.get_wal_addition()->file_id_);
     }
+    log_number = std::max(log_number, record.get_log_number());
 
-    // sst file
-    if (!record.get_new_file().empty()) {
-      for (const auto &new_file : record.get_new_file()) {
-        leveled[new_file.level_].emplace_back(new_file.file_id_);
-        min_recover_wal_id =
-            std::max(new_file.file_id_ + 1, min_recover_wal_id);
+    for (const auto &deleted_file : record.get_deleted_file()) {
+      if (deleted_file.level_ < leveled.size()) {
+        leveled[deleted_file.level_].erase(deleted_file.file_id_);
       }
     }
+    for (const auto &new_file : record.get_new_file()) {
+      if (new_file.level_ >= leveled.size()) {
+        leveled.resize(new_file.level_ + 1);
+      }
+      leveled[new_file.level_][new_file.file_id_] = new_file;
+      next_file_id = std::max(new_file.file_id_ + 1, next_file_id);
+    }
+  }
+
+  levels_.resize(std::max(levels_.size(), leveled.size()));
+  std::set<uint64_t> live_ids;
+  for (size_t level = 0; level < leveled.size(); level++) {
+    for (auto &[file_id, new_file] : leveled[level]) {
+      live_ids.insert(file_id);
+      levels_[level].push_back(std::make_shared<const SSTHandle>(
+          SSTHandle{.id_ = new_file.file_id_,
+                    .smallest_key_ = new_file.smallest_key_,
+                    .largest_key_ = new_file.largest_key_,
+                    .file_size_ = new_file.file_size_}));
+    }
+    if (level > 0) {
+      std::ranges::sort(levels_[level], [](auto &lhs, auto &rhs) {
+        return compare_bytes(lhs->smallest_key_, rhs->smallest_key_) < 0;
+      });
+    }
   }
 
-  // assume SST has 1 level.
-  for (auto [level_id, level_data] : leveled) {
-    for (auto &file_id : level_data) {
-      auto path =
-          std::vformat(sst_pattern_view, std::make_format_args(file_id));
-      sst_.emplace_back(std::make_unique<SST>(path));
+  // SSTs a compaction made obsolete, or written by a flush or compaction
+  // that never reached the manifest
+  if (!opt_.sst_directory_.empty()) {
+    for (auto &entry :
+         std::filesystem::directory_iterator(opt_.sst_directory_)) {
+      auto file_name = entry.path().filename().string();
+      if (file_name.size() <= 4 || !file_name.starts_with("sst_") ||
+          file_name.find_first_not_of("0123456789", 4) != std::string::npos) {
+        continue;
+      }
+      if (!live_ids.contains(std::stoull(file_name.substr(4)))) {
+        std::filesystem::remove(entry.path());
+      }
     }
   }
 
+  // replaying a flushed WAL would flush its SST id a second time, while a
+  // compaction may have moved or deleted the first one
+  auto is_flushed = [&](uint64_t wal_id) { return wal_id < log_number; };
+  // flushed WALs a crash left behind before deleting them
+  if (std::filesystem::exists(opt_.wal_directory_)) {
+    for (auto &entry :
+         std::filesystem::directory_iterator(opt_.wal_directory_)) {
+      auto file_name = entry.path().filename().string();
+      if (!file_name.ends_with(".wal") || file_name.size() <= 4 ||
+          file_name.find_first_not_of("0123456789") != file_name.size() - 4) {
+        continue;
+      }
+      if (is_flushed(std::stoull(file_name))) {
+        std::filesystem::remove(entry.path());
+      }
+    }
+  }
   for (auto &wal_id : wal) {
-    auto path = std::vformat(wal_pattern_view, std::make_format_args(wal_id));
+    if (is_flushed(wal_id)) {
+      continue;
+    }
     immutable_memtable_.emplace_back(
-        MemTable::recover(path, wal_id, opt_.mem_table_size_));
+        MemTable::recover(wal_path(wal_id), wal_id, opt_.mem_table_size_));
   }
 
-  if (!sst_.empty()) {
-    latest_table_id_ = sst_.back()->get_id() + 1;
-  }
+  log_number_ = log_number;
+  // a snapshot only keeps the live SSTs, new ids must stay above every
+  // flushed WAL as well
+  latest_table_id_ = std::max(next_file_id, log_number);
 
   if (!immutable_memtable_.empty()) {
     latest_table_id_ =
@@ -164,16 +600,57 @@ void Storage::recover(const std::vector<VersionEdit> &manifest_records) {
 void Storage::new_active_memtable() {
   latest_table_id_++;
   active_memtable_ =
-      std::make_unique<MemTable>(opt_.mem_table_size_, latest_table_id_);
-  auto wal_path =
-      opt_.wal_directory_ / (std::to_string(latest_table_id_) + ".wal");
-  active_wal_ = std::make_unique<WAL>(wal_path);
+      std::make_shared<MemTable>(opt_.mem_table_size_, latest_table_id_);
+  active_wal_ = std::make_unique<WAL>(
+      wal_path(latest_table_id_),
+      WALConfig{.sync_option_ = opt_.wal_sync_option,
+                .buffer_size_ = opt_.wal_buffer_size_,
+                .sync_interval_ = opt_.wal_sync_interval_,
+                .bytes_per_sync_ = opt_.wal_bytes_per_sync_});
   VersionEdit version_edit;
   version_edit.add_new_wal(latest_table_id_);
+  write_manifest(version_edit);
+}
+
+void Storage::write_manifest(const VersionEdit &version_edit) {
   manifest_.add_record(version_edit);
+  if (manifest_.file_size() < opt_.max_manifest_file_size_) {
+    return;
+  }
+  // the live SSTs with the WAL watermark, then the live WALs oldest first
+  std::vector<VersionEdit> snapshot(1);
+  snapshot[0].set_log_number(log_number_);
+  for (uint64_t level = 0; level < levels_.size(); level++) {
+    for (auto &file : levels_[level]) {
+      snapshot[0].add_new_file(level, file->id_, file->smallest_key_,
+                               file->largest_key_, file->file_size_);
+    }
+  }
+  for (auto &mem_table : immutable_memtable_) {
+    snapshot.emplace_back().add_new_wal(mem_table->get_id());
+  }
+  // close flushes the active memtable too
+  if (active_memtable_ && active_memtable_->get_id() >= log_number_) {
+    snapshot.emplace_back().add_new_wal(active_memtable_->get_id());
+  }
+  manifest_.rewrite(snapshot);
+}
+
+std::filesystem::path Storage::wal_path(uint64_t wal_id) const {
+  return opt_.wal_directory_ / (std::to_string(wal_id) + ".wal");
+}
+
+void Storage::install_super_version() {
+  auto version = std::make_shared<SuperVersion>();
+  version->active_memtable_ = active_memtable_;
+  version->immutable_memtable_ = immutable_memtable_;
+  version->levels_ = levels_;
+  super_version_.store(std::move(version), std::memory_order_release);
 }
 
 void Storage::flush_run(bool flush_all) {
+  // two runs would flush the same memtables, then both erase them
+  std::lock_guard run_lk{flush_run_mu_};
   std::vector<std::shared_ptr<MemTable>> flush_memtables;
   int flush_memtable_count = 0;
 
@@ -181,6 +658,7 @@ void Storage::flush_run(bool flush_all) {
     std::shared_lock lk{mu_};
     if (flush_all) {
       flush_memtables = immutable_memtable_;
+      flush_memtable_count = flush_memtables.size();
     } else {
       flush_memtable_count =
           std::max(static_cast<int>(immutable_memtable_.size()) -
@@ -193,35 +671,237 @@ void Storage::flush_run(bool flush_all) {
           immutable_memtable_.begin() + flush_memtable_count);
     }
   }
+  if (flush_memtables.empty()) {
+    // a stall asks for a flush_all even when everything is flushed already
+    return;
+  }
 
+  auto flush_start = std::chrono::steady_clock::now();
+  for (auto &mem_table : flush_memtables) {
+    stats_.record_flush(std::chrono::duration_cast<std::chrono::microseconds>(
+        flush_start - mem_table->get_frozen_time()));
+  }
   auto sst = flush_to_SST(flush_memtables);
+  for (auto &table : sst) {
+    stats_.record_flush_write(table->file_size());
+  }
+  // the WALs are deleted once the manifest holds the SSTs
+  sync_ssts(sst);
 
   {
     std::lock_guard lk{mu_};
     VersionEdit version_edit;
     for (auto &table : sst) {
-      version_edit.add_new_file(0, table->get_id());
+      auto handle = SSTHandle::from_sst(*table);
+      version_edit.add_new_file(0, handle.id_, handle.smallest_key_,
+                                handle.largest_key_, handle.file_size_);
+      levels_[0].push_back(
+          std::make_shared<const SSTHandle>(std::move(handle)));
+      table_cache_->insert(std::move(table));
     }
-    manifest_.add_record(version_edit);
-    sst_.insert(sst_.end(), std::make_move_iterator(sst.begin()),
-                std::make_move_iterator(sst.end()));
+    // memtables are flushed oldest first, and their ids grow with age
+    log_number_ = flush_memtables.back()->get_id() + 1;
+    version_edit.set_log_number(log_number_);
     immutable_memtable_.erase(immutable_memtable_.begin(),
                               immutable_memtable_.begin() +
                                   flush_memtable_count);
+    write_manifest(version_edit);
+    install_super_version();
+  }
+  // the manifest now holds the SSTs, the WALs are not needed anymore
+  for (auto &mem_table : flush_memtables) {
+    std::filesystem::remove(wal_path(mem_table->get_id()));
+  }
+  stall_cv_.notify_all();
+  schedule_compaction();
+}
+
+void Storage::sync_ssts(
+    const std::vector<std::shared_ptr<SST>> &tables) const {
+  if (tables.empty()) {
+    return;
+  }
+  for (auto &table : tables) {
+    FileWriter(table_cache_->sst_path(table->get_id())).sync();
+  }
+  sync_directory(opt_.sst_directory_);
+}
+
+void Storage::compact_run() {
+  std::lock_guard run_lk{compact_run_mu_};
+  while (!stopped_.load(std::memory_order_acquire)) {
+    std::optional<Compaction> compaction;
+    {
+      auto version = super_version_.load(std::memory_order_acquire);
+      compaction = compaction_picker_->pick(version->levels_);
+    }
+    if (!compaction.has_value()) {
+      break;
+    }
+    run_compaction(compaction.value());
+    // drop the references to the inputs before looking for obsolete SSTs
+    compaction.reset();
+    delete_obsolete_files();
+  }
+}
+
+void Storage::compaction_thread() {
+  while (true) {
+    {
+      std::unique_lock lk{compaction_mu_};
+      compaction_cv_.wait(lk, [this]() {
+        return compaction_pending_ ||
+               stopped_.load(std::memory_order_acquire);
+      });
+      if (stopped_.load(std::memory_order_acquire)) {
+        return;
+      }
+      compaction_pending_ = false;
+    }
+    compact_run();
+  }
+}
+
+void Storage::schedule_compaction() {
+  {
+    std::lock_guard lk{compaction_mu_};
+    compaction_pending_ = true;
+  }
+  compaction_cv_.notify_one();
+}
+
+void Storage::run_compaction(const Compaction &compaction) {
+  std::vector<std::shared_ptr<SST>> outputs;
+  if (!compaction.is_trivial_move()) {
+    CompactionJob job(
+        compaction, *table_cache_, make_sst_config(), opt_.target_file_size_,
+        [this]() {
+          std::lock_guard lk{mu_};
+          return ++latest_table_id_;
+        },
+        opt_.max_subcompactions_, compaction_pool_.get());
+    outputs = job.run();
+    stats_.record_compaction(job.bytes_read(), job.bytes_written());
+  }
+  // the edit deletes the inputs, the outputs must survive a crash first
+  sync_ssts(outputs);
+  install_compaction(compaction, outputs);
+}
+
+void Storage::install_compaction(const Compaction &compaction,
+                                 std::vector<std::shared_ptr<SST>> &outputs) {
+  {
+    std::lock_guard lk{mu_};
+    VersionEdit version_edit;
+    for (auto &input : compaction.inputs_) {
+      for (auto &file : input.files_) {
+        version_edit.delete_file(input.level_, file->id_);
+        std::erase(levels_[input.level_], file);
+      }
+    }
+
+    auto &output_level = levels_[compaction.output_level_];
+    auto add_output = [&](std::shared_ptr<const SSTHandle> handle) {
+      version_edit.add_new_file(compaction.output_level_, handle->id_,
+                                handle->smallest_key_, handle->largest_key_,
+                                handle->file_size_);
+      output_level.push_back(std::move(handle));
+    };
+    if (compaction.is_trivial_move()) {
+      add_output(compaction.inputs_.front().files_.front());
+    } else {
+      for (auto &input : compaction.all_inputs()) {
+        obsolete_sst_.emplace_back(input->id_, input);
+      }
+      for (auto &table : outputs) {
+        add_output(std::make_shared<const SSTHandle>(
+            SSTHandle::from_sst(*table)));
+        table_cache_->insert(std::move(table));
+      }
+    }
+    std::ranges::sort(output_level, [](auto &lhs, auto &rhs) {
+      return compare_bytes(lhs->smallest_key_, rhs->smallest_key_) < 0;
+    });
+    write_manifest(version_edit);
+    install_super_version();
+  }
+  // level 0 may have dropped under the write stall limits
+  stall_cv_.notify_all();
+}
+
+void Storage::delete_obsolete_files() {
+  std::vector<uint64_t> obsolete_ids;
+  {
+    std::lock_guard lk{mu_};
+    std::erase_if(obsolete_sst_, [&obsolete_ids](auto &file) {
+      if (!file.second.expired()) {
+        return false;
+      }
+      obsolete_ids.push_back(file.first);
+      return true;
+    });
+  }
+  for (auto sst_id : obsolete_ids) {
+    table_cache_->evict(sst_id);
+    // a file left behind is deleted by the next recovery
+    std::error_code ec;
+    std::filesystem::remove(table_cache_->sst_path(sst_id), ec);
   }
 }
 
 void Storage::close() {
-  stopped_.store(true, std::memory_order_release);
+  {
+    std::lock_guard lk{flush_mu_};
+    stopped_.store(true, std::memory_order_release);
+  }
+  flush_cv_.notify_one();
   flush_thread_.join();
+  {
+    // the compaction thread checks stopped_ under compaction_mu_
+    std::lock_guard lk{compaction_mu_};
+  }
+  compaction_cv_.notify_one();
+  compaction_thread_.join();
+  {
+    // a stalled writer checks stopped_ under mu_, taking it here makes sure
+    // the writer is either waiting on stall_cv_ or sees stopped_
+    std::lock_guard lk{mu_};
+  }
+  stall_cv_.notify_all();
+  {
+    // the queued writers either commit to the active memtable or fail in
+    // the stall, no write lands in it after the freeze below
+    std::unique_lock wlk{write_mu_};
+    writers_drained_cv_.wait(wlk, [this]() { return writers_.empty(); });
+  }
 
-  active_memtable_->freeze();
-  immutable_memtable_.push_back(std::move(active_memtable_));
+  {
+    // keep active_memtable_ set, readers may still hold its super version
+    std::lock_guard lk{mu_};
+    active_memtable_->freeze();
+    immutable_memtable_.push_back(active_memtable_);
+  }
   flush_run(true);
+  delete_obsolete_files();
 }
 
 uint64_t Storage::get_current_table_id() { return latest_table_id_; }
 
+StorageStats Storage::get_stats() const {
+  auto stats = stats_.snapshot();
+  if (block_cache_) {
+    stats.block_cache_hit_count_ = block_cache_->hits();
+    stats.block_cache_miss_count_ = block_cache_->misses();
+  }
+  stats.table_cache_hit_count_ = table_cache_->hits();
+  stats.table_cache_miss_count_ = table_cache_->misses();
+  auto version = super_version_.load(std::memory_order_acquire);
+  for (auto &level : version->levels_) {
+    stats.level_file_count_.push_back(level.size());
+  }
+  return stats;
+}
+
 Storage::~Storage() {
   // TODO: release the unique_ptr, shared_ptr?
   if (!stopped_.load(std::memory_order_acquire))
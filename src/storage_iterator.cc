@@ -0,0 +1,40 @@
+#include "storage_iterator.hpp"
+#include "utils.hpp"
+
+StorageIterator::StorageIterator(std::unique_ptr<MergeIterator> iter,
+                                 std::vector<std::byte> upper)
+    : iter_(std::move(iter)), upper_(std::move(upper)) {
+  skip_tombstones();
+}
+
+void StorageIterator::next() {
+  if (!is_valid()) {
+    return;
+  }
+  iter_->next();
+  skip_tombstones();
+}
+
+void StorageIterator::seek(const std::vector<std::byte> &target) {
+  iter_->seek(target);
+  skip_tombstones();
+}
+
+std::span<const std::byte> StorageIterator::key_view() {
+  return iter_->key_view();
+}
+
+std::span<const std::byte> StorageIterator::value_view() {
+  return iter_->value_view();
+}
+
+bool StorageIterator::is_valid() {
+  return iter_->is_valid() &&
+         (upper_.empty() || compare_bytes(iter_->key_view(), upper_) < 0);
+}
+
+void StorageIterator::skip_tombstones() {
+  while (is_valid() && iter_->value_view().empty()) {
+    iter_->next();
+  }
+}
@@ -0,0 +1,40 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(size_t n_threads) {
+  if (n_threads == 0) {
+    n_threads = 1;
+  }
+  workers_.reserve(n_threads);
+  for (size_t i = 0; i < n_threads; i++) {
+    workers_.emplace_back([this]() { this->worker(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lk{mu_};
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::size() const { return workers_.size(); }
+
+void ThreadPool::worker() {
+  while (true) {
+    std::move_only_function<void()> task;
+    {
+      std::unique_lock lk{mu_};
+      cv_.wait(lk, [this]() { return stopped_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
@@ -1,17 +1,137 @@
 #include "version_edit.hpp"
+#include "utils.hpp"
+#include <limits>
+#include <stdexcept>
 
-void VersionEdit::add_new_file(uint64_t level, uint64_t file_id) {
-  new_files_.insert(NewFileMetadata{.level_ = level, .file_id_ = file_id});
+namespace {
+void append_key(std::vector<std::byte> &out, std::span<const std::byte> key) {
+  if (key.size() > std::numeric_limits<uint16_t>::max()) {
+    throw std::invalid_argument("key too long for the manifest");
+  }
+  out.append_range(encode_uint16_t(key.size()));
+  out.append_range(key);
+}
+
+// reads the fields of an encoded VersionEdit in order
+class Decoder {
+public:
+  explicit Decoder(std::span<const std::byte> data) : data_(data) {}
+  bool empty() const { return data_.empty(); }
+
+  std::span<const std::byte> take(size_t length) {
+    if (length > data_.size()) {
+      throw std::runtime_error("truncated version edit");
+    }
+    auto bytes = data_.first(length);
+    data_ = data_.subspan(length);
+    return bytes;
+  }
+  uint8_t take_uint8() { return std::to_integer<uint8_t>(take(1)[0]); }
+  uint64_t take_uint64() { return decode_uint64_t(take(8).first<8>()); }
+  std::vector<std::byte> take_key() {
+    auto encoded_len = take(2).first<2>();
+    auto key = take(decode_uint16_t(encoded_len));
+    return {key.begin(), key.end()};
+  }
+
+private:
+  std::span<const std::byte> data_;
+};
+} // namespace
+
+void VersionEdit::add_new_file(uint64_t level, uint64_t file_id,
+                               std::vector<std::byte> smallest_key,
+                               std::vector<std::byte> largest_key,
+                               uint64_t file_size) {
+  new_files_.insert(NewFileMetadata{.level_ = level,
+                                    .file_id_ = file_id,
+                                    .smallest_key_ = std::move(smallest_key),
+                                    .largest_key_ = std::move(largest_key),
+                                    .file_size_ = file_size});
+}
+
+void VersionEdit::delete_file(uint64_t level, uint64_t file_id) {
+  deleted_files_.insert(
+      DeletedFileMetadata{.level_ = level, .file_id_ = file_id});
 }
 
 void VersionEdit::add_new_wal(uint64_t wal_id) {
   wal_addition_ = WALAddition{.file_id_ = wal_id};
 }
 
+void VersionEdit::set_log_number(uint64_t log_number) {
+  log_number_ = log_number;
+}
+
 const std::set<NewFileMetadata> &VersionEdit::get_new_file() const {
   return new_files_;
 }
 
+const std::set<DeletedFileMetadata> &VersionEdit::get_deleted_file() const {
+  return deleted_files_;
+}
+
 const std::optional<WALAddition> &VersionEdit::get_wal_addition() const {
   return wal_addition_;
 }
+
+uint64_t VersionEdit::get_log_number() const { return log_number_; }
+
+std::vector<std::byte> VersionEdit::encode() const {
+  std::vector<std::byte> out;
+  for (auto &new_file : new_files_) {
+    out.push_back(std::byte(Tag::NEW_FILE));
+    out.append_range(encode_uint64_t(new_file.level_));
+    out.append_range(encode_uint64_t(new_file.file_id_));
+    append_key(out, new_file.smallest_key_);
+    append_key(out, new_file.largest_key_);
+    out.append_range(encode_uint64_t(new_file.file_size_));
+  }
+  for (auto &deleted_file : deleted_files_) {
+    out.push_back(std::byte(Tag::DELETED_FILE));
+    out.append_range(encode_uint64_t(deleted_file.level_));
+    out.append_range(encode_uint64_t(deleted_file.file_id_));
+  }
+  if (wal_addition_.has_value()) {
+    out.push_back(std::byte(Tag::WAL_ADDITION));
+    out.append_range(encode_uint64_t(wal_addition_->file_id_));
+  }
+  if (log_number_ > 0) {
+    out.push_back(std::byte(Tag::LOG_NUMBER));
+    out.append_range(encode_uint64_t(log_number_));
+  }
+  return out;
+}
+
+VersionEdit VersionEdit::decode(std::span<const std::byte> data) {
+  VersionEdit edit;
+  Decoder decoder(data);
+  while (!decoder.empty()) {
+    switch (static_cast<Tag>(decoder.take_uint8())) {
+    case Tag::NEW_FILE: {
+      NewFileMetadata new_file;
+      new_file.level_ = decoder.take_uint64();
+      new_file.file_id_ = decoder.take_uint64();
+      new_file.smallest_key_ = decoder.take_key();
+      new_file.largest_key_ = decoder.take_key();
+      new_file.file_size_ = decoder.take_uint64();
+      edit.new_files_.insert(std::move(new_file));
+      break;
+    }
+    case Tag::DELETED_FILE: {
+      uint64_t level = decoder.take_uint64();
+      edit.delete_file(level, decoder.take_uint64());
+      break;
+    }
+    case Tag::WAL_ADDITION:
+      edit.add_new_wal(decoder.take_uint64());
+      break;
+    case Tag::LOG_NUMBER:
+      edit.set_log_number(decoder.take_uint64());
+      break;
+    default:
+      throw std::runtime_error("unknown version edit field");
+    }
+  }
+  return edit;
+}
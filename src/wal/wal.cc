@@ -2,6 +2,7 @@
 #include "io/file_reader.hpp"
 #include "io/file_writer.hpp"
 #include "utils.hpp"
+#include "write_batch.hpp"
 
 std::vector<std::byte> WALRecord::encode() const {
   std::vector<std::byte> encoded_bytes;
@@ -14,64 +15,206 @@ std::vector<std::byte> WALRecord::encode() const {
   return encoded_bytes;
 }
 
-WAL::WAL(const std::filesystem::path &path)
-    : writer_(std::make_unique<FileWriter>(path)) {}
+WAL::WAL(const std::filesystem::path &path, WALConfig config)
+    : config_(config), writer_(std::make_unique<FileWriter>(path)) {
+  if (config_.sync_option_ == WALSyncOption::SYNC_PERIODIC) {
+    sync_thread_ = std::thread([this]() { this->sync_thread(); });
+  }
+}
 
 void WAL::add_record_and_sync(const WALRecord &wal_record) {
-  auto encoded_record = wal_record.encode();
-  writer_->append_and_sync(encoded_record);
+  std::lock_guard lk{mu_};
+  encode_frame(std::span<const WALRecord>(&wal_record, 1), buffer_);
+  write_buffer();
+  writer_->sync();
+  unsynced_bytes_ = 0;
 }
 
 void WAL::add_record(const WALRecord &wal_record) {
-  records_.push_back(wal_record);
+  std::lock_guard lk{mu_};
+  encode_frame(std::span<const WALRecord>(&wal_record, 1), buffer_);
+  maybe_write_buffer();
+}
+
+void WAL::add_batch(const WriteBatch &batch) {
+  std::lock_guard lk{mu_};
+  encode_frame(batch.records(), buffer_);
+  maybe_write_buffer();
+}
+
+void WAL::add_batches(std::span<const WriteBatch *const> batches) {
+  std::lock_guard lk{mu_};
+  for (auto *batch : batches) {
+    encode_frame(batch->records(), buffer_);
+  }
+  maybe_write_buffer();
+}
+
+void WAL::add_batches_and_sync(std::span<const WriteBatch *const> batches) {
+  std::lock_guard lk{mu_};
+  for (auto *batch : batches) {
+    encode_frame(batch->records(), buffer_);
+  }
+  write_buffer();
+  writer_->sync();
+  unsynced_bytes_ = 0;
+}
+
+void WAL::sync() {
+  {
+    std::lock_guard lk{mu_};
+    write_buffer();
+    unsynced_bytes_ = 0;
+  }
+  writer_->sync();
+}
+
+void WAL::maybe_write_buffer() {
+  if (buffer_.size() < config_.buffer_size_) {
+    return;
+  }
+  write_buffer();
+  if (config_.sync_option_ == WALSyncOption::SYNC_PERIODIC &&
+      unsynced_bytes_ >= config_.bytes_per_sync_) {
+    sync_cv_.notify_one();
+  }
+}
+
+void WAL::write_buffer() {
+  if (buffer_.empty()) {
+    return;
+  }
+  writer_->append(buffer_);
+  unsynced_bytes_ += buffer_.size();
+  buffer_.clear();
+}
+
+void WAL::sync_thread() {
+  std::unique_lock lk{mu_};
+  while (!stopped_) {
+    sync_cv_.wait_for(lk, config_.sync_interval_, [this]() {
+      return stopped_ || unsynced_bytes_ >= config_.bytes_per_sync_;
+    });
+    if (stopped_) {
+      break;
+    }
+    write_buffer();
+    if (unsynced_bytes_ == 0) {
+      continue;
+    }
+    unsynced_bytes_ = 0;
+    lk.unlock();
+    writer_->sync();
+    lk.lock();
+  }
+}
+
+void WAL::encode_frame(std::span<const WALRecord> records,
+                       std::vector<std::byte> &out) {
+  size_t frame_start = out.size();
+  out.resize(frame_start + FRAME_LENGTH_ENCODED_SIZE +
+             FRAME_CHECKSUM_ENCODED_SIZE);
+  size_t payload_start = out.size();
+  for (auto &record : records) {
+    out.append_range(record.encode());
+  }
+
+  std::span<const std::byte> payload{out.begin() + payload_start, out.end()};
+  auto encoded_len = encode_uint32_t(payload.size());
+  auto encoded_checksum = encode_uint32_t(crc32c(payload));
+  std::copy(encoded_len.begin(), encoded_len.end(), out.begin() + frame_start);
+  std::copy(encoded_checksum.begin(), encoded_checksum.end(),
+            out.begin() + frame_start + FRAME_LENGTH_ENCODED_SIZE);
 }
 
 std::vector<WALRecord> WAL::read_wal(const std::filesystem::path &path) {
   FileReader reader(path);
-  std::vector<WALRecord> wal_records_;
-  uint64_t curr_offset = 0;
   std::vector<std::byte> buffer;
-  while (curr_offset < reader.file_size()) {
-    WALRecord record;
-
-    buffer.resize(WALRecord::KEY_LENGTH_ENCODED_SIZE);
-    reader.read(curr_offset, WALRecord::KEY_LENGTH_ENCODED_SIZE, buffer);
-    std::span<const std::byte, WALRecord::KEY_LENGTH_ENCODED_SIZE> buffer_span{
-        buffer.data(), buffer.size()};
-    auto key_length = decode_uint16_t(buffer_span);
-
-    curr_offset += WALRecord::KEY_LENGTH_ENCODED_SIZE;
-    buffer.resize(key_length);
-    reader.read(curr_offset, key_length, buffer);
-    record.key_ = std::move(buffer);
-
-    curr_offset += key_length;
-    buffer.resize(WALRecord::VALUE_LENGTH_ENCODED_SIZE);
-    reader.read(curr_offset, WALRecord::VALUE_LENGTH_ENCODED_SIZE, buffer);
-    buffer_span =
-        std::span<const std::byte, WALRecord::VALUE_LENGTH_ENCODED_SIZE>{
-            buffer.data(), buffer.size()};
-    auto value_length = decode_uint16_t(buffer_span);
-
-    curr_offset += WALRecord::VALUE_LENGTH_ENCODED_SIZE;
-    buffer.resize(value_length);
-    reader.read(curr_offset, value_length, buffer);
-    record.value_ = std::move(buffer);
-
-    curr_offset += value_length;
-    wal_records_.emplace_back(record);
+  buffer.resize(reader.file_size());
+  reader.read(0, buffer.size(), buffer);
+
+  std::vector<WALRecord> wal_records_;
+  std::span<const std::byte> data{buffer};
+  const size_t header_size =
+      FRAME_LENGTH_ENCODED_SIZE + FRAME_CHECKSUM_ENCODED_SIZE;
+  while (data.size() >= header_size) {
+    auto payload_len =
+        decode_uint32_t(data.subspan<0, FRAME_LENGTH_ENCODED_SIZE>());
+    auto checksum = decode_uint32_t(
+        data.subspan<FRAME_LENGTH_ENCODED_SIZE,
+                     FRAME_CHECKSUM_ENCODED_SIZE>());
+    if (data.size() - header_size < payload_len) {
+      // torn frame at the tail of the log
+      break;
+    }
+    auto payload = data.subspan(header_size, payload_len);
+    if (crc32c(payload) != checksum) {
+      break;
+    }
+
+    // decode into a staging vector so a malformed frame adds nothing
+    std::vector<WALRecord> frame_records;
+    bool malformed = false;
+    while (!payload.empty()) {
+      WALRecord record;
+      if (payload.size() < WALRecord::KEY_LENGTH_ENCODED_SIZE) {
+        malformed = true;
+        break;
+      }
+      auto key_len_span =
+          payload.subspan<0, WALRecord::KEY_LENGTH_ENCODED_SIZE>();
+      auto key_length = decode_uint16_t(key_len_span);
+      payload = payload.subspan(WALRecord::KEY_LENGTH_ENCODED_SIZE);
+      if (payload.size() <
+          static_cast<size_t>(key_length) +
+              WALRecord::VALUE_LENGTH_ENCODED_SIZE) {
+        malformed = true;
+        break;
+      }
+      record.key_.assign(payload.begin(), payload.begin() + key_length);
+      payload = payload.subspan(key_length);
+
+      auto value_len_span =
+          payload.subspan<0, WALRecord::VALUE_LENGTH_ENCODED_SIZE>();
+      auto value_length = decode_uint16_t(value_len_span);
+      payload = payload.subspan(WALRecord::VALUE_LENGTH_ENCODED_SIZE);
+      if (payload.size() < value_length) {
+        malformed = true;
+        break;
+      }
+      record.value_.assign(payload.begin(), payload.begin() + value_length);
+      payload = payload.subspan(value_length);
+      frame_records.emplace_back(std::move(record));
+    }
+    if (malformed) {
+      break;
+    }
+
+    wal_records_.insert(wal_records_.end(),
+                        std::make_move_iterator(frame_records.begin()),
+                        std::make_move_iterator(frame_records.end()));
+    data = data.subspan(header_size + payload_len);
   }
 
   return wal_records_;
 }
 
 WAL::~WAL() {
-  if (!records_.empty()) {
-    std::vector<std::byte> encoded_records;
-    for (auto &record : records_) {
-      encoded_records.append_range(record.encode());
+  if (sync_thread_.joinable()) {
+    {
+      std::lock_guard lk{mu_};
+      stopped_ = true;
     }
-    writer_->append_and_sync(encoded_records);
+    sync_cv_.notify_one();
+    sync_thread_.join();
+  }
+
+  {
+    std::lock_guard lk{mu_};
+    write_buffer();
+  }
+  if (unsynced_bytes_ > 0) {
+    writer_->sync();
   }
   writer_.reset();
 }
@@ -0,0 +1,24 @@
+#include "write_batch.hpp"
+
+void WriteBatch::put(const std::vector<std::byte> &key,
+                     const std::vector<std::byte> &value) {
+  records_.push_back({.key_ = key, .value_ = value});
+  byte_size_ += key.size() + value.size();
+}
+
+// an empty value is the tombstone, see Storage::remove
+void WriteBatch::remove(const std::vector<std::byte> &key) {
+  records_.push_back({.key_ = key, .value_ = {}});
+  byte_size_ += key.size();
+}
+
+void WriteBatch::clear() {
+  records_.clear();
+  byte_size_ = 0;
+}
+
+size_t WriteBatch::count() const { return records_.size(); }
+
+uint64_t WriteBatch::byte_size() const { return byte_size_; }
+
+const std::vector<WALRecord> &WriteBatch::records() const { return records_; }
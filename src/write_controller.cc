@@ -0,0 +1,52 @@
+#include "write_controller.hpp"
+#include <algorithm>
+
+WriteController::WriteController(WriteControllerConfig config)
+    : config_(config) {}
+
+WriteStall WriteController::get_stall(const WritePressure &pressure) const {
+  double ratio = get_max_ratio(pressure);
+  if (ratio > 1) {
+    return WriteStall::STOPPED;
+  }
+  if (ratio > 0) {
+    return WriteStall::DELAYED;
+  }
+  return WriteStall::NONE;
+}
+
+std::chrono::microseconds
+WriteController::get_delay(const WritePressure &pressure) const {
+  double ratio = get_max_ratio(pressure);
+  if (ratio <= 0 || ratio > 1) {
+    return std::chrono::microseconds{0};
+  }
+  return std::chrono::microseconds{
+      static_cast<int64_t>(config_.max_delay_.count() * ratio)};
+}
+
+double WriteController::get_ratio(uint64_t val, uint64_t soft_limit,
+                                  uint64_t hard_limit) {
+  if (hard_limit != 0 && val >= hard_limit) {
+    return 2;
+  }
+  if (soft_limit == 0 || val < soft_limit) {
+    return 0;
+  }
+  if (hard_limit <= soft_limit) {
+    return 1;
+  }
+  return static_cast<double>(val - soft_limit + 1) /
+         static_cast<double>(hard_limit - soft_limit + 1);
+}
+
+double WriteController::get_max_ratio(const WritePressure &pressure) const {
+  return std::max({get_ratio(pressure.immutable_memtables_,
+                             config_.immutable_memtable_soft_limit_,
+                             config_.immutable_memtable_hard_limit_),
+                   get_ratio(pressure.pending_bytes_,
+                             config_.pending_bytes_soft_limit_,
+                             config_.pending_bytes_hard_limit_),
+                   get_ratio(pressure.l0_ssts_, config_.l0_sst_soft_limit_,
+                             config_.l0_sst_hard_limit_)});
+}
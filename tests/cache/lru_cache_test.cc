@@ -0,0 +1,81 @@
+#include "lru_cache.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LRUCacheTest : public ::testing::Test {};
+
+TEST_F(LRUCacheTest, LookupAfterInsert) {
+  ShardedLRUCache<int, std::string> cache{1024};
+  EXPECT_FALSE(cache.lookup(1).has_value());
+  cache.insert(1, "one", 10);
+  cache.insert(2, "two", 10);
+
+  EXPECT_EQ(cache.lookup(1), "one");
+  EXPECT_EQ(cache.lookup(2), "two");
+  EXPECT_EQ(cache.hits(), 2);
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_EQ(cache.usage(), 20);
+}
+
+TEST_F(LRUCacheTest, InsertReplacesValue) {
+  ShardedLRUCache<int, std::string> cache{1024};
+  cache.insert(1, "one", 10);
+  cache.insert(1, "uno", 30);
+  EXPECT_EQ(cache.lookup(1), "uno");
+  EXPECT_EQ(cache.usage(), 30);
+
+  cache.erase(1);
+  EXPECT_FALSE(cache.lookup(1).has_value());
+  EXPECT_EQ(cache.usage(), 0);
+}
+
+TEST_F(LRUCacheTest, EvictsLeastRecentlyUsed) {
+  // single shard so that every key competes for the same capacity
+  ShardedLRUCache<int, int> cache{30, 1};
+  cache.insert(1, 1, 10);
+  cache.insert(2, 2, 10);
+  cache.insert(3, 3, 10);
+
+  // touch 1, 2 becomes the least recently used entry
+  EXPECT_TRUE(cache.lookup(1).has_value());
+  cache.insert(4, 4, 10);
+
+  EXPECT_FALSE(cache.lookup(2).has_value());
+  EXPECT_TRUE(cache.lookup(1).has_value());
+  EXPECT_TRUE(cache.lookup(3).has_value());
+  EXPECT_TRUE(cache.lookup(4).has_value());
+  EXPECT_EQ(cache.usage(), 30);
+}
+
+TEST_F(LRUCacheTest, OversizedEntryIsNotCached) {
+  ShardedLRUCache<int, int> cache{64, 4};
+  cache.insert(1, 1, 17);
+  EXPECT_FALSE(cache.lookup(1).has_value());
+  cache.insert(1, 1, 16);
+  EXPECT_TRUE(cache.lookup(1).has_value());
+}
+
+TEST_F(LRUCacheTest, ConcurrentAccess) {
+  ShardedLRUCache<int, int> cache{1000};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache, t]() {
+      for (int i = 0; i < 10000; ++i) {
+        int key = (i * 7 + t) % 500;
+        auto value = cache.lookup(key);
+        if (value.has_value()) {
+          EXPECT_EQ(value.value(), key);
+        } else {
+          cache.insert(key, key, 1);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(cache.usage(), 1000);
+  EXPECT_EQ(cache.hits() + cache.misses(), 80000);
+}
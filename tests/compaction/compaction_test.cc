@@ -0,0 +1,307 @@
+#include "compaction/compaction.hpp"
+#include "sst/sst_builder.hpp"
+#include "sst/sst_iterator.hpp"
+#include "test_utilities.hpp"
+#include <filesystem>
+#include <format>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+
+using test_utils::BytesToString;
+using test_utils::MakeBytesVector;
+
+namespace {
+std::shared_ptr<const SSTHandle> make_handle(uint64_t id, std::string smallest,
+                                             std::string largest,
+                                             uint64_t file_size = 100) {
+  return std::make_shared<const SSTHandle>(
+      SSTHandle{.id_ = id,
+                .smallest_key_ = MakeBytesVector(std::move(smallest)),
+                .largest_key_ = MakeBytesVector(std::move(largest)),
+                .file_size_ = file_size});
+}
+} // namespace
+
+TEST(CompactionPickerTest, NothingToPickBelowTriggers) {
+  LeveledCompactionPicker picker(CompactionOptions{
+      .num_levels_ = 3,
+      .level0_file_num_compaction_trigger_ = 2,
+      .max_bytes_for_level_base_ = 1000});
+  std::vector<LevelFiles> levels(3);
+  levels[0] = {make_handle(1, "a", "c")};
+  levels[1] = {make_handle(2, "a", "z", 900)};
+  EXPECT_FALSE(picker.pick(levels).has_value());
+  EXPECT_DOUBLE_EQ(picker.score(levels, 0), 0.5);
+  EXPECT_DOUBLE_EQ(picker.score(levels, 1), 0.9);
+  EXPECT_EQ(picker.max_bytes_for_level(2), 10000);
+}
+
+TEST(CompactionPickerTest, Level0TakesEverySSTAndTheOverlappingLevel1) {
+  LeveledCompactionPicker picker(CompactionOptions{
+      .num_levels_ = 3, .level0_file_num_compaction_trigger_ = 2});
+  std::vector<LevelFiles> levels(3);
+  levels[0] = {make_handle(5, "c", "e"), make_handle(6, "d", "g")};
+  levels[1] = {make_handle(1, "a", "b"), make_handle(2, "c", "d"),
+               make_handle(3, "f", "h"), make_handle(4, "x", "z")};
+
+  auto compaction = picker.pick(levels);
+  ASSERT_TRUE(compaction.has_value());
+  EXPECT_EQ(compaction->output_level_, 1);
+  ASSERT_EQ(compaction->inputs_.size(), 2);
+  EXPECT_EQ(compaction->inputs_[0].level_, 0);
+  EXPECT_EQ(compaction->inputs_[0].files_, levels[0]);
+  EXPECT_EQ(compaction->inputs_[1].level_, 1);
+  EXPECT_EQ(compaction->inputs_[1].files_,
+            (LevelFiles{levels[1][1], levels[1][2]}));
+  EXPECT_TRUE(compaction->bottommost_);
+  EXPECT_FALSE(compaction->is_trivial_move());
+  // newest first
+  EXPECT_EQ(compaction->all_inputs(),
+            (LevelFiles{levels[0][1], levels[0][0], levels[1][1],
+                        levels[1][2]}));
+}
+
+TEST(CompactionPickerTest, DeeperLevelGoesRoundItsKeySpace) {
+  LeveledCompactionPicker picker(CompactionOptions{
+      .num_levels_ = 4, .max_bytes_for_level_base_ = 100});
+  std::vector<LevelFiles> levels(4);
+  levels[1] = {make_handle(1, "a", "b"), make_handle(2, "c", "d"),
+               make_handle(3, "e", "f")};
+  levels[2] = {make_handle(4, "c", "c")};
+  levels[3] = {make_handle(5, "e", "e")};
+
+  std::vector<uint64_t> picked;
+  for (int i = 0; i < 4; i++) {
+    auto compaction = picker.pick(levels);
+    ASSERT_TRUE(compaction.has_value());
+    EXPECT_EQ(compaction->inputs_.front().level_, 1);
+    ASSERT_EQ(compaction->inputs_.front().files_.size(), 1);
+    picked.push_back(compaction->inputs_.front().files_.front()->id_);
+  }
+  EXPECT_EQ(picked, (std::vector<uint64_t>{1, 2, 3, 1}));
+
+  // SST 2 merges with SST 4. SST 3 overlaps nothing in level 2 and only
+  // moves down, level 3 still holds "e" so its tombstones must stay.
+  auto first = picker.pick(levels);
+  ASSERT_EQ(first->inputs_.size(), 2);
+  EXPECT_EQ(first->inputs_[0].files_.front()->id_, 2);
+  EXPECT_EQ(first->inputs_[1].files_, LevelFiles{levels[2][0]});
+  EXPECT_TRUE(first->bottommost_);
+  auto second = picker.pick(levels);
+  EXPECT_TRUE(second->is_trivial_move());
+  EXPECT_FALSE(second->bottommost_);
+}
+
+TEST(CompactionPickerTest, FindFile) {
+  LevelFiles level = {make_handle(1, "b", "d"), make_handle(2, "f", "h")};
+  EXPECT_EQ(find_file(level, MakeBytesVector("a")), level.size());
+  EXPECT_EQ(find_file(level, MakeBytesVector("b")), 0);
+  EXPECT_EQ(find_file(level, MakeBytesVector("d")), 0);
+  EXPECT_EQ(find_file(level, MakeBytesVector("e")), level.size());
+  EXPECT_EQ(find_file(level, MakeBytesVector("g")), 1);
+  EXPECT_EQ(find_file(level, MakeBytesVector("i")), level.size());
+}
+
+TEST(TieredCompactionPickerTest, NothingToPickBelowTrigger) {
+  TieredCompactionPicker picker(CompactionOptions{
+      .num_levels_ = 4, .level0_file_num_compaction_trigger_ = 3});
+  std::vector<LevelFiles> levels(4);
+  levels[0] = {make_handle(1, "a", "c")};
+  levels[3] = {make_handle(2, "a", "z", 100)};
+  EXPECT_FALSE(picker.pick(levels).has_value());
+}
+
+TEST(TieredCompactionPickerTest, SpaceAmplificationMergesEveryRun) {
+  TieredCompactionPicker picker(CompactionOptions{
+      .num_levels_ = 4, .level0_file_num_compaction_trigger_ = 2});
+  std::vector<LevelFiles> levels(4);
+  levels[0] = {make_handle(3, "a", "c", 150), make_handle(4, "b", "d", 150)};
+  levels[2] = {make_handle(1, "a", "b", 100), make_handle(2, "c", "d", 100)};
+
+  auto compaction = picker.pick(levels);
+  ASSERT_TRUE(compaction.has_value());
+  EXPECT_EQ(compaction->output_level_, 2);
+  ASSERT_EQ(compaction->inputs_.size(), 2);
+  EXPECT_EQ(compaction->inputs_[0].files_, levels[0]);
+  EXPECT_EQ(compaction->inputs_[1].files_, levels[2]);
+  EXPECT_TRUE(compaction->bottommost_);
+  EXPECT_EQ(compaction->all_inputs(),
+            (LevelFiles{levels[0][1], levels[0][0], levels[2][0],
+                        levels[2][1]}));
+}
+
+TEST(TieredCompactionPickerTest, SizeRatioMergesRunsOfSimilarSize) {
+  TieredCompactionPicker picker(CompactionOptions{
+      .num_levels_ = 4, .level0_file_num_compaction_trigger_ = 3});
+  std::vector<LevelFiles> levels(4);
+  levels[0] = {make_handle(2, "a", "c"), make_handle(3, "b", "d"),
+               make_handle(4, "c", "e")};
+  levels[3] = {make_handle(1, "a", "z", 10000)};
+
+  // the level 0 runs go to the deepest empty level above level 3
+  auto compaction = picker.pick(levels);
+  ASSERT_TRUE(compaction.has_value());
+  EXPECT_EQ(compaction->output_level_, 2);
+  ASSERT_EQ(compaction->inputs_.size(), 1);
+  EXPECT_EQ(compaction->inputs_[0].files_, levels[0]);
+  EXPECT_FALSE(compaction->bottommost_);
+
+  // a streak of runs of similar size may start after a smaller, newer run,
+  // which stays in level 0
+  levels[0] = {make_handle(5, "a", "c", 1000), make_handle(6, "b", "d", 1000),
+               make_handle(7, "c", "e", 10)};
+  compaction = picker.pick(levels);
+  ASSERT_TRUE(compaction.has_value());
+  EXPECT_EQ(compaction->output_level_, 2);
+  EXPECT_EQ(compaction->inputs_[0].files_,
+            (LevelFiles{levels[0][0], levels[0][1]}));
+}
+
+TEST(TieredCompactionPickerTest, OtherwiseMergesTheNewestRuns) {
+  TieredCompactionPicker picker(CompactionOptions{
+      .num_levels_ = 4, .level0_file_num_compaction_trigger_ = 3});
+  std::vector<LevelFiles> levels(4);
+  levels[0] = {make_handle(4, "a", "c", 1000), make_handle(5, "b", "d", 100),
+               make_handle(6, "c", "e", 10)};
+  levels[3] = {make_handle(1, "a", "z", 10000)};
+
+  // the three newest runs leave two sorted runs, under the trigger
+  auto compaction = picker.pick(levels);
+  ASSERT_TRUE(compaction.has_value());
+  EXPECT_EQ(compaction->output_level_, 2);
+  ASSERT_EQ(compaction->inputs_.size(), 1);
+  EXPECT_EQ(compaction->inputs_[0].files_, levels[0]);
+}
+
+TEST(TieredCompactionPickerTest, Level0RunsMergeIntoAnOccupiedLevel1) {
+  TieredCompactionPicker picker(CompactionOptions{
+      .num_levels_ = 3,
+      .level0_file_num_compaction_trigger_ = 3,
+      .max_size_amplification_percent_ = 1000});
+  std::vector<LevelFiles> levels(3);
+  levels[0] = {make_handle(3, "a", "c"), make_handle(4, "b", "d")};
+  levels[1] = {make_handle(2, "a", "z", 1000)};
+  levels[2] = {make_handle(1, "a", "z", 10000)};
+
+  // there is no empty level between level 0 and level 1 for the two level 0
+  // runs, level 1 is merged in
+  auto compaction = picker.pick(levels);
+  ASSERT_TRUE(compaction.has_value());
+  EXPECT_EQ(compaction->output_level_, 1);
+  ASSERT_EQ(compaction->inputs_.size(), 2);
+  EXPECT_EQ(compaction->inputs_[0].files_, levels[0]);
+  EXPECT_EQ(compaction->inputs_[1].files_, levels[1]);
+  EXPECT_FALSE(compaction->bottommost_);
+  EXPECT_FALSE(compaction->is_trivial_move());
+}
+
+class CompactionJobTest : public ::testing::Test {
+protected:
+  void SetUp() override { std::filesystem::create_directories(sst_directory_); }
+  void TearDown() override { std::filesystem::remove_all(sst_directory_); }
+
+  // SST sst_id with the keys [first, last), tombstones when value is empty
+  std::shared_ptr<const SSTHandle> build_sst(uint64_t sst_id, int first,
+                                             int last,
+                                             const std::string &value) {
+    SSTConfig config{.block_size_ = 256, .sst_directory_ = sst_directory_};
+    SSTBuilder builder(sst_directory_ / ("sst_" + std::to_string(sst_id)),
+                       config);
+    for (int i = first; i < last; i++) {
+      builder.add_entry(MakeBytesVector(std::format("key{:03}", i)),
+                        MakeBytesVector(std::string(value)));
+    }
+    return std::make_shared<const SSTHandle>(
+        SSTHandle::from_sst(builder.build()));
+  }
+
+  const std::filesystem::path sst_directory_{"/tmp/mini_lsm_compaction"};
+};
+
+TEST_F(CompactionJobTest, KeepsNewestVersionsAndSplitsOutputs) {
+  auto old_sst = build_sst(1, 0, 100, "old");
+  auto new_sst = build_sst(2, 50, 150, "new");
+  auto deleted = build_sst(3, 0, 10, "");
+  Compaction compaction{
+      .inputs_ = {CompactionInput{.level_ = 0,
+                                  .files_ = {old_sst, new_sst, deleted}}},
+      .output_level_ = 1,
+      .bottommost_ = true};
+
+  TableCache table_cache(sst_directory_, 10, nullptr, SSTReadMode::PREAD);
+  uint64_t next_id = 10;
+  CompactionJob job(compaction, table_cache,
+                    SSTConfig{.block_size_ = 256,
+                              .sst_directory_ = sst_directory_},
+                    1024, [&next_id]() { return next_id++; });
+  auto outputs = job.run();
+  ASSERT_GT(outputs.size(), 1);
+  EXPECT_EQ(job.bytes_read(), old_sst->file_size_ + new_sst->file_size_ +
+                                  deleted->file_size_);
+
+  uint64_t bytes_written = 0;
+  int i = 10;
+  for (size_t output = 0; output < outputs.size(); output++) {
+    EXPECT_EQ(outputs[output]->get_id(), 10 + output);
+    bytes_written += outputs[output]->file_size();
+    if (output > 0) {
+      EXPECT_LT(outputs[output - 1]->largest_key(),
+                outputs[output]->smallest_key());
+    }
+    for (SSTIterator iter(outputs[output]); iter.is_valid(); iter.next()) {
+      EXPECT_EQ(BytesToString(iter.key()), std::format("key{:03}", i));
+      EXPECT_EQ(BytesToString(iter.value()), i < 50 ? "old" : "new");
+      i++;
+    }
+  }
+  // the tombstones of the bottommost level are dropped
+  EXPECT_EQ(i, 150);
+  EXPECT_EQ(job.bytes_written(), bytes_written);
+}
+
+TEST_F(CompactionJobTest, SubcompactionsSplitTheKeySpace) {
+  auto old_sst = build_sst(1, 0, 400, "old");
+  auto new_sst = build_sst(2, 200, 600, "new");
+  auto deleted = build_sst(3, 0, 50, "");
+  Compaction compaction{
+      .inputs_ = {CompactionInput{.level_ = 0,
+                                  .files_ = {old_sst, new_sst, deleted}}},
+      .output_level_ = 1,
+      .bottommost_ = true};
+
+  TableCache table_cache(sst_directory_, 10, nullptr, SSTReadMode::PREAD);
+  ThreadPool thread_pool(4);
+  std::mutex mu;
+  uint64_t next_id = 10;
+  CompactionJob job(
+      compaction, table_cache,
+      SSTConfig{.block_size_ = 256, .sst_directory_ = sst_directory_},
+      1 << 20,
+      [&]() {
+        std::lock_guard lk{mu};
+        return next_id++;
+      },
+      4, &thread_pool);
+  auto outputs = job.run();
+  EXPECT_EQ(job.subcompactions(), 4);
+  // every range ends its own output
+  ASSERT_EQ(outputs.size(), 4);
+
+  uint64_t bytes_written = 0;
+  int i = 50;
+  for (size_t output = 0; output < outputs.size(); output++) {
+    bytes_written += outputs[output]->file_size();
+    if (output > 0) {
+      EXPECT_LT(outputs[output - 1]->largest_key(),
+                outputs[output]->smallest_key());
+    }
+    for (SSTIterator iter(outputs[output]); iter.is_valid(); iter.next()) {
+      EXPECT_EQ(BytesToString(iter.key()), std::format("key{:03}", i));
+      EXPECT_EQ(BytesToString(iter.value()), i < 200 ? "old" : "new");
+      i++;
+    }
+  }
+  EXPECT_EQ(i, 600);
+  EXPECT_EQ(job.bytes_written(), bytes_written);
+}
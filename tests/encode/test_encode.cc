@@ -20,3 +20,28 @@ TEST_F(EncodingTest, U64DecodeTest) {
   auto decode_val = decode_uint64_t(encoded_val);
   EXPECT_EQ(expected_result, decode_val);
 }
+
+TEST_F(EncodingTest, U32EncodeDecodeTest) {
+  auto encode_result = encode_uint32_t(0x735d65cb);
+  std::array<std::byte, 4> expected_result{
+      {std::byte(0x73), std::byte(0x5d), std::byte(0x65), std::byte(0xcb)}};
+  EXPECT_EQ(encode_result, expected_result);
+  EXPECT_EQ(decode_uint32_t(encode_result), 0x735d65cb);
+}
+
+TEST_F(EncodingTest, Crc32cTest) {
+  // standard check value of CRC-32C
+  std::string input = "123456789";
+  std::vector<std::byte> bytes;
+  for (char c : input) {
+    bytes.push_back(static_cast<std::byte>(c));
+  }
+  EXPECT_EQ(crc32c(bytes), 0xE3069283);
+
+  // extending a crc is the same as computing it in one go
+  auto first = crc32c(std::span<const std::byte>(bytes).subspan(0, 4));
+  EXPECT_EQ(crc32c(std::span<const std::byte>(bytes).subspan(4), first),
+            0xE3069283);
+  EXPECT_NE(crc32c(std::span<const std::byte>(bytes).subspan(1)),
+            0xE3069283);
+}
@@ -1,7 +1,10 @@
 #include "io/file_reader.hpp"
+#include <atomic>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <thread>
 
 class FileReaderTest : public ::testing::Test {
 protected:
@@ -36,3 +39,99 @@ TEST_F(FileReaderTest, ReadTest) {
   reader.read(2, 5, buffer);
   EXPECT_EQ(buffer, expected_buffer);
 }
+
+TEST_F(FileReaderTest, ReadBatchTest) {
+  test_file_.write("hello_world!", 12);
+  test_file_.close();
+
+  FileReader reader{std::filesystem::path(FILE_PATH_)};
+  std::vector<std::byte> world(5), hello(5), bang(1), empty;
+  // out of order, hello and the underscore gap are not adjacent to world
+  std::vector<FileReader::ReadRequest> requests{
+      {.offset_ = 6, .buffer_ = world},
+      {.offset_ = 0, .buffer_ = hello},
+      {.offset_ = 11, .buffer_ = bang},
+      {.offset_ = 3, .buffer_ = empty}};
+  reader.read_batch(requests);
+
+  EXPECT_EQ(hello, (std::vector<std::byte>{std::byte('h'), std::byte('e'),
+                                           std::byte('l'), std::byte('l'),
+                                           std::byte('o')}));
+  EXPECT_EQ(world, (std::vector<std::byte>{std::byte('w'), std::byte('o'),
+                                           std::byte('r'), std::byte('l'),
+                                           std::byte('d')}));
+  EXPECT_EQ(bang, std::vector<std::byte>{std::byte('!')});
+}
+
+TEST_F(FileReaderTest, ReadPastEndThrows) {
+  test_file_.write("hello", 5);
+  test_file_.close();
+
+  FileReader reader{std::filesystem::path(FILE_PATH_)};
+  std::vector<std::byte> buffer(4);
+  EXPECT_THROW(reader.read(3, 4, buffer), std::runtime_error);
+}
+
+TEST_F(FileReaderTest, ConcurrentReadsTest) {
+  std::string content;
+  for (int i = 0; i < 4096; i++) {
+    content.push_back(static_cast<char>('a' + i % 26));
+  }
+  test_file_.write(content.data(), content.size());
+  test_file_.close();
+
+  FileReader reader{std::filesystem::path(FILE_PATH_)};
+  std::vector<std::thread> threads;
+  std::atomic<int> mismatches{0};
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<std::byte> buffer(16);
+      for (int i = 0; i < 1000; i++) {
+        size_t offset = (t * 1000 + i * 7) % (content.size() - 16);
+        reader.read(offset, 16, buffer);
+        if (std::memcmp(buffer.data(), content.data() + offset, 16) != 0) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(mismatches, 0);
+}
+
+TEST_F(FileReaderTest, IoUringReadBatchTest) {
+  std::string content;
+  for (int i = 0; i < 64 * 1024; i++) {
+    content.push_back(static_cast<char>('a' + i % 23));
+  }
+  test_file_.write(content.data(), content.size());
+  test_file_.close();
+
+  // falls back to pread where io_uring is not allowed, the result is the same
+  FileReader reader{std::filesystem::path(FILE_PATH_),
+                    FileReader::Backend::IO_URING};
+  // more requests than the ring holds, none of them adjacent
+  std::vector<std::vector<std::byte>> buffers(200);
+  std::vector<FileReader::ReadRequest> requests;
+  for (size_t i = 0; i < buffers.size(); i++) {
+    buffers[i].resize(100 + i);
+    requests.push_back({.offset_ = (i * 311) % (content.size() - 400),
+                        .buffer_ = buffers[i]});
+  }
+  reader.read_batch(requests);
+
+  for (size_t i = 0; i < buffers.size(); i++) {
+    EXPECT_EQ(std::memcmp(buffers[i].data(),
+                          content.data() + requests[i].offset_,
+                          buffers[i].size()),
+              0);
+  }
+
+  // reading past the end still throws, from the pread fallback
+  std::vector<std::byte> tail(16);
+  std::vector<FileReader::ReadRequest> past_end{
+      {.offset_ = content.size() - 8, .buffer_ = tail}};
+  EXPECT_THROW(reader.read_batch(past_end), std::runtime_error);
+}
@@ -0,0 +1,107 @@
+#include "merge_iterator.hpp"
+#include "test_utilities.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using test_utils::BytesToString;
+using test_utils::MakeKeyValueEntryFromString;
+
+namespace {
+
+using Entries =
+    std::vector<std::pair<std::vector<std::byte>, std::vector<std::byte>>>;
+
+// iterator over sorted in-memory entries
+class VectorIterator : public Iterator {
+public:
+  VectorIterator(Entries entries) : entries_(std::move(entries)), idx_(0) {}
+  void next() override { idx_++; }
+  void seek(const std::vector<std::byte> &target) override {
+    idx_ = std::lower_bound(entries_.begin(), entries_.end(), target,
+                            [](const auto &entry, const auto &key) {
+                              return entry.first < key;
+                            }) -
+           entries_.begin();
+  }
+  std::span<const std::byte> key_view() override {
+    return entries_[idx_].first;
+  }
+  std::span<const std::byte> value_view() override {
+    return entries_[idx_].second;
+  }
+  bool is_valid() override { return idx_ < entries_.size(); }
+
+private:
+  Entries entries_;
+  size_t idx_;
+};
+
+std::unique_ptr<Iterator>
+make_iterator(const std::vector<std::pair<std::string, std::string>> &kvs) {
+  return std::make_unique<VectorIterator>(MakeKeyValueEntryFromString(kvs));
+}
+
+std::vector<std::pair<std::string, std::string>> collect(Iterator &iter) {
+  std::vector<std::pair<std::string, std::string>> result;
+  while (iter.is_valid()) {
+    result.emplace_back(BytesToString(iter.key()), BytesToString(iter.value()));
+    iter.next();
+  }
+  return result;
+}
+
+} // namespace
+
+class MergeIteratorTest : public ::testing::Test {};
+
+TEST_F(MergeIteratorTest, NoChildren) {
+  MergeIterator iter{{}};
+  EXPECT_FALSE(iter.is_valid());
+}
+
+TEST_F(MergeIteratorTest, MergesInKeyOrder) {
+  std::vector<std::unique_ptr<Iterator>> children;
+  children.push_back(make_iterator({{"b", "1"}, {"e", "1"}}));
+  children.push_back(make_iterator({}));
+  children.push_back(make_iterator({{"a", "2"}, {"c", "2"}, {"f", "2"}}));
+  children.push_back(make_iterator({{"d", "3"}}));
+  MergeIterator iter{std::move(children)};
+
+  std::vector<std::pair<std::string, std::string>> expected{
+      {"a", "2"}, {"b", "1"}, {"c", "2"}, {"d", "3"}, {"e", "1"}, {"f", "2"}};
+  EXPECT_EQ(collect(iter), expected);
+}
+
+TEST_F(MergeIteratorTest, NewestChildWinsOnDuplicates) {
+  std::vector<std::unique_ptr<Iterator>> children;
+  children.push_back(make_iterator({{"a", "new"}, {"c", ""}}));
+  children.push_back(make_iterator({{"a", "mid"}, {"b", "mid"}, {"c", "mid"}}));
+  children.push_back(make_iterator({{"a", "old"}, {"b", "old"}}));
+  MergeIterator iter{std::move(children)};
+
+  // the tombstone of "c" is returned, hiding it is up to the caller
+  std::vector<std::pair<std::string, std::string>> expected{
+      {"a", "new"}, {"b", "mid"}, {"c", ""}};
+  EXPECT_EQ(collect(iter), expected);
+}
+
+TEST_F(MergeIteratorTest, Seek) {
+  std::vector<std::unique_ptr<Iterator>> children;
+  children.push_back(make_iterator({{"b", "1"}, {"d", "1"}}));
+  children.push_back(make_iterator({{"a", "2"}, {"c", "2"}, {"d", "2"}}));
+  MergeIterator iter{std::move(children)};
+
+  iter.seek(test_utils::MakeBytesVector("bb"));
+  std::vector<std::pair<std::string, std::string>> expected{{"c", "2"},
+                                                            {"d", "1"}};
+  EXPECT_EQ(collect(iter), expected);
+
+  iter.seek(test_utils::MakeBytesVector("a"));
+  EXPECT_EQ(collect(iter).size(), 4);
+
+  iter.seek(test_utils::MakeBytesVector("e"));
+  EXPECT_FALSE(iter.is_valid());
+}
@@ -1,10 +1,22 @@
-#include "fcntl.h"
 #include "manifest/manifest.hpp"
 #include "version_edit.hpp"
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 class ManifestTest : public ::testing::Test {
 protected:
-  void TearDown() { unlink(test_path.c_str()); }
+  void TearDown() { std::filesystem::remove_all(test_path); }
+
+  // the one manifest file next to CURRENT
+  std::filesystem::path manifest_file() const {
+    for (auto &entry : std::filesystem::directory_iterator(test_path)) {
+      if (entry.path().filename() != "CURRENT") {
+        return entry.path();
+      }
+    }
+    return {};
+  }
+
   const std::filesystem::path test_path{"manifest-test"};
 };
 
@@ -28,3 +40,131 @@ TEST_F(ManifestTest, EncodeTest) {
     EXPECT_EQ(records, decode_records);
   }
 }
+
+TEST_F(ManifestTest, NewFileKeepsKeyRangeAndSize) {
+  VersionEdit edit;
+  edit.add_new_file(0, 7, {std::byte('a')}, {std::byte('z'), std::byte(0)},
+                    4096);
+  {
+    auto [manifest, _] = Manifest::recover(test_path);
+    manifest.add_record(edit);
+  }
+
+  auto [_, records] = Manifest::recover(test_path);
+  ASSERT_EQ(records.size(), 1);
+  auto &new_file = *records[0].get_new_file().begin();
+  EXPECT_EQ(new_file.file_id_, 7);
+  EXPECT_EQ(new_file.smallest_key_, std::vector<std::byte>{std::byte('a')});
+  EXPECT_EQ(new_file.largest_key_,
+            (std::vector<std::byte>{std::byte('z'), std::byte(0)}));
+  EXPECT_EQ(new_file.file_size_, 4096);
+}
+
+TEST_F(ManifestTest, DeletedFileRoundTrip) {
+  // a compaction moving SST 4 down a level and merging SST 5 away
+  VersionEdit edit;
+  edit.delete_file(0, 4);
+  edit.delete_file(1, 5);
+  edit.add_new_file(1, 4);
+  {
+    auto [manifest, _] = Manifest::recover(test_path);
+    manifest.add_record(edit);
+  }
+
+  auto [_, records] = Manifest::recover(test_path);
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0], edit);
+  EXPECT_EQ(records[0].get_deleted_file().size(), 2);
+  EXPECT_EQ(records[0].get_deleted_file().begin()->file_id_, 4);
+}
+
+TEST_F(ManifestTest, LogNumberRoundTrip) {
+  // a flush of the memtable of WAL 6
+  VersionEdit edit;
+  edit.add_new_file(0, 6);
+  edit.set_log_number(7);
+  {
+    auto [manifest, _] = Manifest::recover(test_path);
+    manifest.add_record(edit);
+  }
+
+  auto [_, records] = Manifest::recover(test_path);
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0], edit);
+  EXPECT_EQ(records[0].get_log_number(), 7);
+}
+
+TEST_F(ManifestTest, TornTailRecordIsDropped) {
+  VersionEdit v0, v1;
+  v0.add_new_file(0, 1);
+  v1.add_new_file(0, 2);
+  {
+    auto [manifest, _] = Manifest::recover(test_path);
+    manifest.add_record(v0);
+    manifest.add_record(v1);
+  }
+  // a crash in the middle of the last append
+  auto path = manifest_file();
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+  VersionEdit v2;
+  v2.add_new_file(0, 3);
+  {
+    auto [manifest, records] = Manifest::recover(test_path);
+    EXPECT_EQ(records, std::vector<VersionEdit>{v0});
+    manifest.add_record(v2);
+  }
+  auto [_, records] = Manifest::recover(test_path);
+  EXPECT_EQ(records, (std::vector<VersionEdit>{v0, v2}));
+}
+
+TEST_F(ManifestTest, CorruptedRecordThrows) {
+  VersionEdit v0, v1;
+  v0.add_new_file(0, 1);
+  v1.add_new_file(0, 2);
+  {
+    auto [manifest, _] = Manifest::recover(test_path);
+    manifest.add_record(v0);
+    manifest.add_record(v1);
+  }
+  {
+    // flip a byte of the file id of the first record
+    std::fstream file(manifest_file(),
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(8 + 1 + 8 + 7);
+    file.put('x');
+  }
+  EXPECT_THROW(Manifest::recover(test_path), std::runtime_error);
+}
+
+TEST_F(ManifestTest, RewriteSwitchesToTheSnapshot) {
+  std::vector<VersionEdit> snapshot(2);
+  snapshot[0].add_new_file(1, 5, {std::byte('a')}, {std::byte('c')}, 100);
+  snapshot[0].set_log_number(9);
+  snapshot[1].add_new_wal(9);
+  VersionEdit after;
+  after.add_new_file(0, 10);
+  {
+    auto [manifest, _] = Manifest::recover(test_path);
+    for (uint64_t i = 0; i < 100; i++) {
+      VersionEdit edit;
+      edit.add_new_file(0, i);
+      manifest.add_record(edit);
+    }
+    auto old_file = manifest_file();
+    auto old_size = manifest.file_size();
+    manifest.rewrite(snapshot);
+    EXPECT_LT(manifest.file_size(), old_size);
+    EXPECT_FALSE(std::filesystem::exists(old_file));
+    manifest.add_record(after);
+  }
+
+  auto [_, records] = Manifest::recover(test_path);
+  ASSERT_EQ(records.size(), 3);
+  EXPECT_EQ(records[0], snapshot[0]);
+  EXPECT_EQ(records[0].get_new_file().begin()->file_size_, 100);
+  EXPECT_EQ(records[1], snapshot[1]);
+  EXPECT_NE(records[1], VersionEdit{});
+  EXPECT_EQ(records[1].get_wal_addition()->file_id_, 9);
+  EXPECT_EQ(records[2], after);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "arena.hpp"
+#include "memtable.hpp"
+#include "test_utilities.hpp"
+
+using test_utils::MakeBytesVector;
+using test_utils::MakeBytesVectorRepeated;
+
+class ArenaTest : public ::testing::Test {};
+
+TEST_F(ArenaTest, AllocationsAreAlignedAndAccounted) {
+  Arena arena{4096};
+  EXPECT_EQ(arena.memory_usage(), 0);
+
+  auto first = arena.allocate(3);
+  auto second = arena.allocate(5);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % alignof(std::max_align_t), 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % alignof(std::max_align_t),
+            0);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(arena.memory_usage(), 2 * alignof(std::max_align_t));
+}
+
+TEST_F(ArenaTest, LargeAllocationGetsDedicatedChunk) {
+  Arena arena{4096};
+  auto small = arena.allocate(16);
+  auto large = arena.allocate(10000);
+  auto next_small = arena.allocate(16);
+
+  // the small allocations keep using the first chunk
+  EXPECT_EQ(next_small, small + 16);
+  EXPECT_NE(large, nullptr);
+  EXPECT_EQ(arena.memory_usage(), 16 + 16 + 10000);
+}
+
+TEST_F(ArenaTest, RetiredChunkTailIsCounted) {
+  Arena arena{4096};
+  arena.allocate(1008);
+  arena.allocate(1008);
+  arena.allocate(1008);
+  arena.allocate(1008);
+  EXPECT_EQ(arena.memory_usage(), 4032);
+
+  // does not fit in the 64 remaining bytes, the tail is wasted
+  arena.allocate(1008);
+  EXPECT_EQ(arena.memory_usage(), 4096 + 1008);
+}
+
+TEST_F(ArenaTest, ConcurrentAllocationsDoNotOverlap) {
+  Arena arena{4096};
+  const int num_threads = 4;
+  const int allocs_per_thread = 1000;
+  std::vector<std::vector<std::byte *>> results(num_threads);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < allocs_per_thread; ++i) {
+        auto ptr = arena.allocate(16);
+        std::fill(ptr, ptr + 16, std::byte(t));
+        results[t].push_back(ptr);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < num_threads; ++t) {
+    for (auto ptr : results[t]) {
+      for (int i = 0; i < 16; ++i) {
+        ASSERT_EQ(ptr[i], std::byte(t));
+      }
+    }
+  }
+  EXPECT_GE(arena.memory_usage(), num_threads * allocs_per_thread * 16);
+}
+
+TEST_F(ArenaTest, MemTableSizeIncludesOverhead) {
+  MemTable memtable{1 << 20};
+  EXPECT_GT(memtable.size(), 0); // skiplist head node
+
+  auto base = memtable.size();
+  auto key = MakeBytesVector("key");
+  auto value = MakeBytesVectorRepeated('v', 100);
+  memtable.put(key, value);
+  EXPECT_GT(memtable.size(), base + key.size() + value.size());
+
+  // overwritten values stay in the arena until the memtable is dropped
+  auto after_put = memtable.size();
+  memtable.put(key, value);
+  EXPECT_GT(memtable.size(), after_put);
+}
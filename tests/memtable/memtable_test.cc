@@ -326,3 +326,54 @@ TEST_F(MemTableThreadSafetyTest, SequentialWritesThenConcurrentMixedOps) {
     thread.join();
   }
 }
+
+TEST_F(MemTableThreadSafetyTest, ConcurrentWritersAndReaders) {
+  const int num_writers = 4;
+  const int num_readers = 4;
+  const int puts_per_writer = 500;
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < num_writers; ++t) {
+    threads.emplace_back([this, t, puts_per_writer]() {
+      for (int i = 0; i < puts_per_writer; ++i) {
+        auto key = MakeBytesVector("w" + std::to_string(t) + "_" +
+                                   std::to_string(i));
+        auto value = MakeBytesVector("value" + std::to_string(i));
+        memtable.put(key, value);
+      }
+    });
+  }
+  for (int t = 0; t < num_readers; ++t) {
+    threads.emplace_back([this, t, puts_per_writer]() {
+      for (int i = 0; i < puts_per_writer; ++i) {
+        auto key = MakeBytesVector("w" + std::to_string(t) + "_" +
+                                   std::to_string(i));
+        auto result = memtable.get(key);
+        if (result.has_value()) {
+          EXPECT_EQ(BytesToString(result.value()),
+                    "value" + std::to_string(i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < num_writers; ++t) {
+    for (int i = 0; i < puts_per_writer; ++i) {
+      auto key =
+          MakeBytesVector("w" + std::to_string(t) + "_" + std::to_string(i));
+      ASSERT_TRUE(memtable.get(key).has_value());
+    }
+  }
+
+  memtable.freeze();
+  int count = 0;
+  auto iter = memtable.get_iteartor();
+  while (iter.is_valid()) {
+    count++;
+    iter.next();
+  }
+  EXPECT_EQ(count, num_writers * puts_per_writer);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "skiplist.hpp"
+#include "test_utilities.hpp"
+
+using test_utils::BytesToString;
+using test_utils::MakeBytesVector;
+
+namespace {
+std::vector<std::byte> to_vector(std::span<const std::byte> bytes) {
+  return std::vector<std::byte>(bytes.begin(), bytes.end());
+}
+} // namespace
+
+class SkipListTest : public ::testing::Test {
+protected:
+  SkipList skiplist;
+};
+
+TEST_F(SkipListTest, InsertReturnsReplacedValueSize) {
+  auto key = MakeBytesVector("key");
+  auto value1 = MakeBytesVector("value1");
+  auto value2 = MakeBytesVector("v2");
+
+  EXPECT_FALSE(skiplist.insert(key, value1).has_value());
+  auto replaced = skiplist.insert(key, value2);
+  ASSERT_TRUE(replaced.has_value());
+  EXPECT_EQ(replaced.value(), value1.size());
+  EXPECT_EQ(BytesToString(skiplist.get(key).value()), "v2");
+  EXPECT_EQ(skiplist.count(), 1);
+}
+
+TEST_F(SkipListTest, GetAtSequenceSkipsNewerValues) {
+  auto key = MakeBytesVector("key");
+  auto value1 = MakeBytesVector("value1");
+  auto value2 = MakeBytesVector("value2");
+  skiplist.insert(key, value1, 5);
+  skiplist.insert(key, value2, 7);
+
+  EXPECT_FALSE(skiplist.get(key, 4).has_value());
+  EXPECT_EQ(BytesToString(skiplist.get(key, 5).value()), "value1");
+  EXPECT_EQ(BytesToString(skiplist.get(key, 6).value()), "value1");
+  EXPECT_EQ(BytesToString(skiplist.get(key, 7).value()), "value2");
+  EXPECT_EQ(BytesToString(skiplist.get(key).value()), "value2");
+}
+
+TEST_F(SkipListTest, IterateInKeyOrder) {
+  std::vector<std::string> keys{"banana", "apple", "cherry", "a", "b", ""};
+  for (auto &key : keys) {
+    skiplist.insert(MakeBytesVector(std::string(key)),
+                    MakeBytesVector("v_" + key));
+  }
+  std::sort(keys.begin(), keys.end());
+
+  size_t idx = 0;
+  for (auto node = skiplist.first(); node != nullptr; node = node->next(0)) {
+    ASSERT_LT(idx, keys.size());
+    EXPECT_EQ(BytesToString(to_vector(node->key())), keys[idx]);
+    idx++;
+  }
+  EXPECT_EQ(idx, keys.size());
+}
+
+TEST_F(SkipListTest, SeekFindsFirstGreaterOrEqual) {
+  for (auto key : {"b", "d", "f"}) {
+    skiplist.insert(MakeBytesVector(key), MakeBytesVector("v"));
+  }
+  EXPECT_EQ(
+      BytesToString(to_vector(skiplist.seek(MakeBytesVector("a"))->key())),
+      "b");
+  EXPECT_EQ(
+      BytesToString(to_vector(skiplist.seek(MakeBytesVector("d"))->key())),
+      "d");
+  EXPECT_EQ(
+      BytesToString(to_vector(skiplist.seek(MakeBytesVector("e"))->key())),
+      "f");
+  EXPECT_EQ(skiplist.seek(MakeBytesVector("g")), nullptr);
+}
+
+TEST_F(SkipListTest, ConcurrentWritersDisjointKeys) {
+  const int num_threads = 8;
+  const int puts_per_thread = 2000;
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([this, t, puts_per_thread]() {
+      for (int i = 0; i < puts_per_thread; ++i) {
+        auto key = MakeBytesVector("key" + std::to_string(i) + "_" +
+                                   std::to_string(t));
+        auto value = MakeBytesVector("value" + std::to_string(i));
+        skiplist.insert(key, value);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(skiplist.count(), num_threads * puts_per_thread);
+  for (int t = 0; t < num_threads; ++t) {
+    for (int i = 0; i < puts_per_thread; ++i) {
+      auto key = MakeBytesVector("key" + std::to_string(i) + "_" +
+                                 std::to_string(t));
+      auto result = skiplist.get(key);
+      ASSERT_TRUE(result.has_value());
+      EXPECT_EQ(BytesToString(result.value()), "value" + std::to_string(i));
+    }
+  }
+
+  std::vector<std::byte> prev_key;
+  for (auto node = skiplist.first(); node != nullptr; node = node->next(0)) {
+    if (node != skiplist.first()) {
+      EXPECT_LT(prev_key, to_vector(node->key()));
+    }
+    prev_key = to_vector(node->key());
+  }
+}
+
+TEST_F(SkipListTest, ConcurrentWritersSameKeys) {
+  const int num_threads = 8;
+  const int n_keys = 200;
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([this, t, n_keys]() {
+      for (int i = 0; i < n_keys; ++i) {
+        auto key = MakeBytesVector("key" + std::to_string(i));
+        auto value = MakeBytesVector("thread" + std::to_string(t));
+        skiplist.insert(key, value);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(skiplist.count(), n_keys);
+  for (int i = 0; i < n_keys; ++i) {
+    auto result = skiplist.get(MakeBytesVector("key" + std::to_string(i)));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(BytesToString(result.value()).substr(0, 6), "thread");
+  }
+}
@@ -0,0 +1,74 @@
+#include "sst/block_index.hpp"
+#include "test_utilities.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using test_utils::MakeBytesVector;
+
+class BlockIndexTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    // blocks [b, d], [f, h], [j, j]
+    add("b", "d");
+    add("f", "h");
+    add("j", "j");
+  }
+
+  void add(std::string first, std::string last) {
+    auto first_key = MakeBytesVector(std::move(first));
+    auto last_key = MakeBytesVector(std::move(last));
+    index_.add(index_.size() * 100, 100, first_key, last_key);
+  }
+
+  std::optional<size_t> find(std::string key) {
+    return index_.find(MakeBytesVector(std::move(key)));
+  }
+
+  BlockIndex index_;
+};
+
+TEST_F(BlockIndexTest, Accessors) {
+  ASSERT_EQ(index_.size(), 3);
+  EXPECT_EQ(index_.offset(1), 100);
+  EXPECT_EQ(index_.block_size(1), 100);
+  auto first_key = index_.first_key(1);
+  auto last_key = index_.last_key(1);
+  EXPECT_EQ(std::vector<std::byte>(first_key.begin(), first_key.end()),
+            MakeBytesVector("f"));
+  EXPECT_EQ(std::vector<std::byte>(last_key.begin(), last_key.end()),
+            MakeBytesVector("h"));
+}
+
+TEST_F(BlockIndexTest, FindKeysInsideBlocks) {
+  EXPECT_EQ(find("b"), 0);
+  EXPECT_EQ(find("c"), 0);
+  EXPECT_EQ(find("d"), 0);
+  EXPECT_EQ(find("f"), 1);
+  EXPECT_EQ(find("g"), 1);
+  EXPECT_EQ(find("h"), 1);
+  EXPECT_EQ(find("j"), 2);
+}
+
+TEST_F(BlockIndexTest, FindKeysOutsideBlocks) {
+  EXPECT_EQ(find("a"), std::nullopt);
+  // gaps between blocks
+  EXPECT_EQ(find("e"), std::nullopt);
+  EXPECT_EQ(find("i"), std::nullopt);
+  EXPECT_EQ(find("k"), std::nullopt);
+}
+
+TEST_F(BlockIndexTest, LowerBound) {
+  EXPECT_EQ(index_.lower_bound(MakeBytesVector("a")), 0);
+  EXPECT_EQ(index_.lower_bound(MakeBytesVector("e")), 1);
+  EXPECT_EQ(index_.lower_bound(MakeBytesVector("h")), 1);
+  EXPECT_EQ(index_.lower_bound(MakeBytesVector("hh")), 2);
+  EXPECT_EQ(index_.lower_bound(MakeBytesVector("k")), 3);
+}
+
+TEST_F(BlockIndexTest, EmptyIndex) {
+  BlockIndex index;
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_EQ(index.lower_bound(MakeBytesVector("a")), 0);
+  EXPECT_EQ(index.find(MakeBytesVector("a")), std::nullopt);
+}
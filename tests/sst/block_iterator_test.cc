@@ -79,3 +79,67 @@ TEST_F(BlockIteratorTest, MulitpleEntryBlock) {
   }
   EXPECT_EQ(iter_size, 3);
 }
+
+TEST_F(BlockIteratorTest, Seek) {
+  std::vector<std::pair<std::string, std::string>> entries_str{
+      {"apple", "1"}, {"banana", "2"}, {"mash", "3"}};
+
+  auto entries = MakeKeyValueEntryFromString(entries_str);
+  BlockBuilder builder;
+  for (auto &entry : entries) {
+    builder.add_entry(entry.first, entry.second);
+  }
+  auto block_iter = BlockIterator(std::make_shared<Block>(builder.build()));
+
+  block_iter.seek(test_utils::MakeBytesVector("banana"));
+  ASSERT_TRUE(block_iter.is_valid());
+  EXPECT_EQ(entries[1].first, block_iter.key());
+
+  block_iter.seek(test_utils::MakeBytesVector("c"));
+  ASSERT_TRUE(block_iter.is_valid());
+  EXPECT_EQ(entries[2].first, block_iter.key());
+
+  block_iter.seek(test_utils::MakeBytesVector("a"));
+  ASSERT_TRUE(block_iter.is_valid());
+  EXPECT_EQ(entries[0].first, block_iter.key());
+
+  block_iter.seek(test_utils::MakeBytesVector("zzz"));
+  EXPECT_FALSE(block_iter.is_valid());
+}
+
+TEST_F(BlockIteratorTest, SeekAcrossRestarts) {
+  BlockBuilder builder(3);
+  for (int i = 0; i < 20; i++) {
+    auto key = test_utils::MakeBytesVector("key" + std::to_string(10 + i * 2));
+    auto val = test_utils::MakeBytesVector(std::to_string(i));
+    builder.add_entry(key, val);
+  }
+  auto block_iter = BlockIterator(std::make_shared<Block>(builder.build()));
+
+  for (int i = 0; i < 20; i++) {
+    auto key = test_utils::MakeBytesVector("key" + std::to_string(10 + i * 2));
+    // the odd keys are missing, seek lands on the following even key
+    if (i > 0) {
+      block_iter.seek(
+          test_utils::MakeBytesVector("key" + std::to_string(9 + i * 2)));
+      ASSERT_TRUE(block_iter.is_valid());
+      EXPECT_EQ(block_iter.key(), key);
+    }
+
+    block_iter.seek(key);
+    ASSERT_TRUE(block_iter.is_valid());
+    EXPECT_EQ(block_iter.value(),
+              test_utils::MakeBytesVector(std::to_string(i)));
+  }
+
+  int count = 0;
+  block_iter.seek(test_utils::MakeBytesVector("key40"));
+  while (block_iter.is_valid()) {
+    count++;
+    block_iter.next();
+  }
+  EXPECT_EQ(count, 5); // key40 .. key48
+
+  block_iter.seek(test_utils::MakeBytesVector("key49"));
+  EXPECT_FALSE(block_iter.is_valid());
+}
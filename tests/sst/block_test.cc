@@ -59,12 +59,13 @@ TEST_F(BlockTest, BlockEncodeSingleEntry) {
 
   auto encoded_output = block.encode();
   std::vector<std::byte> expected_encoded{
+      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(5),
       std::byte(0),   std::byte(5),   std::byte('h'), std::byte('e'),
-      std::byte('l'), std::byte('l'), std::byte('o'), std::byte(0),
-      std::byte(5),   std::byte('w'), std::byte('o'), std::byte('r'),
-      std::byte('l'), std::byte('d'), std::byte(0),   std::byte(0), // offset
-      std::byte(0),
-      std::byte(1) // footer
+      std::byte('l'), std::byte('l'), std::byte('o'), std::byte('w'),
+      std::byte('o'), std::byte('r'), std::byte('l'), std::byte('d'),
+      std::byte(0),   std::byte(0), // restart
+      std::byte(0),   std::byte(16), // restart interval
+      std::byte(0),   std::byte(1)  // footer
   };
   EXPECT_EQ(encoded_output.size(), expected_encoded.size());
   EXPECT_EQ(encoded_output, expected_encoded);
@@ -85,13 +86,17 @@ TEST_F(BlockTest, BlockEncodeMultipleEntry) {
 
   auto encoded_output = block.encode();
   std::vector<std::byte> expected_encoded = {
-      std::byte(0),   std::byte(1),   std::byte('a'), std::byte(0),
-      std::byte(1),   std::byte('b'), std::byte(0),   std::byte(1),
-      std::byte('x'), std::byte(0),   std::byte(1),   std::byte('y'),
-      std::byte(0),   std::byte(2),   std::byte('x'), std::byte('x'),
-      std::byte(0),   std::byte(2),   std::byte('y'), std::byte('y'),
-      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(6),
-      std::byte(0),   std::byte(12),  std::byte(0),   std::byte(3) // footer
+      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(1),
+      std::byte(0),   std::byte(1),   std::byte('a'), std::byte('b'),
+      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(1),
+      std::byte(0),   std::byte(1),   std::byte('x'), std::byte('y'),
+      // "xx" shares "x" with the previous key
+      std::byte(0),   std::byte(1),   std::byte(0),   std::byte(1),
+      std::byte(0),   std::byte(2),   std::byte('x'), std::byte('y'),
+      std::byte('y'),
+      std::byte(0),   std::byte(0), // restart
+      std::byte(0),   std::byte(16), // restart interval
+      std::byte(0),   std::byte(3)  // footer
   };
   EXPECT_EQ(encoded_output.size(), expected_encoded.size());
   EXPECT_EQ(encoded_output, expected_encoded);
@@ -99,12 +104,13 @@ TEST_F(BlockTest, BlockEncodeMultipleEntry) {
 
 TEST_F(BlockTest, BlockDecodeSingleEntry) {
   std::vector<std::byte> binary_data{
+      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(5),
       std::byte(0),   std::byte(5),   std::byte('h'), std::byte('e'),
-      std::byte('l'), std::byte('l'), std::byte('o'), std::byte(0),
-      std::byte(5),   std::byte('w'), std::byte('o'), std::byte('r'),
-      std::byte('l'), std::byte('d'), std::byte(0),   std::byte(0), // offset
-      std::byte(0),
-      std::byte(1) // footer
+      std::byte('l'), std::byte('l'), std::byte('o'), std::byte('w'),
+      std::byte('o'), std::byte('r'), std::byte('l'), std::byte('d'),
+      std::byte(0),   std::byte(0), // restart
+      std::byte(0),   std::byte(16), // restart interval
+      std::byte(0),   std::byte(1)  // footer
   };
 
   auto block = Block::decode(binary_data);
@@ -158,3 +164,73 @@ TEST_F(BlockTest, BlockEncodeDecodeMultipleEntry) {
     EXPECT_EQ(entry.value_, records[idx].second);
   }
 }
+
+TEST_F(BlockTest, BlockEncodeRestartPoints) {
+  BlockBuilder builder(2);
+
+  std::vector<std::pair<std::vector<std::byte>, std::vector<std::byte>>>
+      records = {{MakeBytesVector("a"), MakeBytesVector("b")},
+                 {MakeBytesVector("x"), MakeBytesVector("y")},
+                 {MakeBytesVector("xx"), MakeBytesVector("yy")}};
+  for (auto &record : records) {
+    builder.add_entry(record.first, record.second);
+  }
+
+  auto encoded_output = builder.build().encode();
+  std::vector<std::byte> expected_encoded = {
+      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(1),
+      std::byte(0),   std::byte(1),   std::byte('a'), std::byte('b'),
+      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(1),
+      std::byte(0),   std::byte(1),   std::byte('x'), std::byte('y'),
+      // restart point, the full key is stored
+      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(2),
+      std::byte(0),   std::byte(2),   std::byte('x'), std::byte('x'),
+      std::byte('y'), std::byte('y'),
+      std::byte(0),   std::byte(0),   std::byte(0),   std::byte(16), // restarts
+      std::byte(0),   std::byte(2), // restart interval
+      std::byte(0),   std::byte(3)  // footer
+  };
+  EXPECT_EQ(encoded_output, expected_encoded);
+
+  auto decoded_block = Block::decode(encoded_output);
+  for (size_t idx = 0; idx < records.size(); idx++) {
+    auto entry = decoded_block.get_entry(idx);
+    EXPECT_EQ(entry.key_, records[idx].first);
+    EXPECT_EQ(entry.value_, records[idx].second);
+  }
+}
+
+TEST_F(BlockTest, BlockPrefixCompressionShrinksBlock) {
+  BlockBuilder compressed;
+  BlockBuilder uncompressed(1);
+  for (int i = 0; i < 100; i++) {
+    auto key = MakeBytesVector("user_profile_" + std::to_string(1000 + i));
+    auto val = MakeBytesVector("v");
+    compressed.add_entry(key, val);
+    uncompressed.add_entry(key, val);
+  }
+
+  EXPECT_LT(compressed.get_size() * 2, uncompressed.get_size());
+  EXPECT_EQ(compressed.get_size() + 4, compressed.build().encode().size());
+}
+
+TEST_F(BlockTest, BlockGetAcrossRestarts) {
+  BlockBuilder builder(4);
+  for (int i = 0; i < 50; i++) {
+    auto key = MakeBytesVector("key" + std::to_string(100 + i));
+    auto val = MakeBytesVector("value" + std::to_string(i));
+    builder.add_entry(key, val);
+  }
+
+  auto block = Block::decode(builder.build().encode());
+  EXPECT_EQ(block.size(), 50);
+  for (int i = 0; i < 50; i++) {
+    auto key = MakeBytesVector("key" + std::to_string(100 + i));
+    EXPECT_EQ(block.get(key), MakeBytesVector("value" + std::to_string(i)));
+    EXPECT_EQ(block.get_entry(i).key_, key);
+  }
+  EXPECT_EQ(block.get(MakeBytesVector("key099")), std::nullopt);
+  EXPECT_EQ(block.get(MakeBytesVector("key1105")), std::nullopt);
+  EXPECT_EQ(block.get(MakeBytesVector("key150")), std::nullopt);
+  EXPECT_EQ(block.get_last_key(), MakeBytesVector("key149"));
+}
@@ -0,0 +1,51 @@
+#include "sst/bloom_filter.hpp"
+#include "test_utilities.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using test_utils::MakeBytesVector;
+
+class BloomFilterTest : public ::testing::Test {
+protected:
+  BloomFilter build(int n_keys, size_t bits_per_key) {
+    std::vector<uint32_t> key_hashes;
+    for (int i = 0; i < n_keys; ++i) {
+      key_hashes.push_back(
+          BloomFilter::hash(MakeBytesVector("key" + std::to_string(i))));
+    }
+    return BloomFilter(BloomFilter::build(key_hashes, bits_per_key));
+  }
+};
+
+TEST_F(BloomFilterTest, EmptyFilterMatchesEverything) {
+  BloomFilter filter;
+  EXPECT_TRUE(filter.may_contain(MakeBytesVector("hello")));
+
+  auto disabled = build(100, 0);
+  EXPECT_EQ(disabled.size(), 0);
+  EXPECT_TRUE(disabled.may_contain(MakeBytesVector("hello")));
+}
+
+TEST_F(BloomFilterTest, NoFalseNegatives) {
+  for (int n_keys : {1, 10, 100, 10000}) {
+    auto filter = build(n_keys, 10);
+    for (int i = 0; i < n_keys; ++i) {
+      EXPECT_TRUE(
+          filter.may_contain(MakeBytesVector("key" + std::to_string(i))));
+    }
+  }
+}
+
+TEST_F(BloomFilterTest, FalsePositiveRate) {
+  constexpr int n_keys = 10000;
+  auto filter = build(n_keys, 10);
+  int false_positives = 0;
+  for (int i = 0; i < n_keys; ++i) {
+    if (filter.may_contain(MakeBytesVector("missing" + std::to_string(i)))) {
+      false_positives++;
+    }
+  }
+  // ~1% expected with 10 bits per key
+  EXPECT_LT(false_positives, n_keys * 2 / 100);
+}
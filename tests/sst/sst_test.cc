@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <sst/sst_builder.hpp>
 #include <tuple>
@@ -131,3 +132,278 @@ TEST_F(SSTTest, TestSSTIterator) {
   }
   EXPECT_EQ(count, n_entries);
 }
+
+TEST_F(SSTTest, TestSSTIteratorZeroDataBlock) {
+  std::vector<std::byte> footer(8, std::byte(0));
+  tmp_file_.write(reinterpret_cast<char *>(footer.data()), footer.size());
+  tmp_file_.close();
+
+  SSTIterator sst_iter(std::make_shared<SST>(FILE_NAME_));
+  EXPECT_FALSE(sst_iter.is_valid());
+  sst_iter.seek(MakeBytesVector("key"));
+  EXPECT_FALSE(sst_iter.is_valid());
+}
+
+TEST_F(SSTTest, TestSSTIteratorSeek) {
+  SSTConfig config{.block_size_ = 1024};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+  ASSERT_GT(sst.number_of_block(), 1);
+  SSTIterator sst_iter(std::make_shared<SST>(std::move(sst)));
+
+  // keys are sorted as strings: key0, key1, key10, key100, key101, ...
+  sst_iter.seek(MakeBytesVector("key500"));
+  ASSERT_TRUE(sst_iter.is_valid());
+  EXPECT_EQ(sst_iter.key(), MakeBytesVector("key500"));
+  sst_iter.next();
+  EXPECT_EQ(sst_iter.key(), MakeBytesVector("key501"));
+
+  // between two keys
+  sst_iter.seek(MakeBytesVector("key5000"));
+  ASSERT_TRUE(sst_iter.is_valid());
+  EXPECT_EQ(sst_iter.key(), MakeBytesVector("key501"));
+
+  sst_iter.seek(MakeBytesVector("a"));
+  ASSERT_TRUE(sst_iter.is_valid());
+  EXPECT_EQ(sst_iter.key(), MakeBytesVector("key0"));
+
+  int count = 0;
+  sst_iter.seek(MakeBytesVector("key998"));
+  while (sst_iter.is_valid()) {
+    count++;
+    sst_iter.next();
+  }
+  EXPECT_EQ(count, 2); // key998, key999
+
+  sst_iter.seek(MakeBytesVector("zzz"));
+  EXPECT_FALSE(sst_iter.is_valid());
+}
+
+TEST_F(SSTTest, TestSSTFilterSkipsMissingKeys) {
+  SSTConfig config{.block_size_ = 1024};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+
+  int false_positives = 0;
+  for (int i = 0; i < n_entries; i++) {
+    // these fall inside the key range of the SST blocks
+    auto key_vec = MakeBytesVector("key" + std::to_string(i) + "x");
+    if (sst.may_contain(key_vec)) {
+      false_positives++;
+    }
+    EXPECT_FALSE(sst.get(key_vec).has_value());
+  }
+  EXPECT_LT(false_positives, n_entries * 2 / 100);
+}
+
+TEST_F(SSTTest, TestSSTWithoutFilter) {
+  SSTConfig config{.block_size_ = 1024, .bloom_bits_per_key_ = 0};
+  int n_entries = 100;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+
+  auto missing = MakeBytesVector("key1x");
+  EXPECT_TRUE(sst.may_contain(missing));
+  EXPECT_FALSE(sst.get(missing).has_value());
+  for (int i = 0; i < n_entries; i++) {
+    auto key_vec = MakeBytesVector("key" + std::to_string(i));
+    EXPECT_EQ(sst.get(key_vec), MakeBytesVector("value" + std::to_string(i)));
+  }
+}
+
+TEST_F(SSTTest, TestSSTBlockCache) {
+  auto block_cache = std::make_shared<BlockCache>(1 << 20);
+  SSTConfig config{.block_size_ = 1024, .block_cache_ = block_cache};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+
+  auto key_vec = MakeBytesVector("key42");
+  EXPECT_EQ(sst.get(key_vec), MakeBytesVector("value42"));
+  EXPECT_EQ(block_cache->misses(), 1);
+  EXPECT_EQ(sst.get(key_vec), MakeBytesVector("value42"));
+  EXPECT_EQ(block_cache->hits(), 1);
+
+  // the iterator shares the cached blocks
+  SSTIterator sst_iter(std::make_shared<SST>(std::move(sst)));
+  int count = 0;
+  while (sst_iter.is_valid()) {
+    count++;
+    sst_iter.next();
+  }
+  EXPECT_EQ(count, n_entries);
+  EXPECT_EQ(block_cache->hits(), 2);
+  EXPECT_GT(block_cache->usage(), 0);
+}
+
+TEST_F(SSTTest, TestSSTIteratorViewsPinCachedBlocks) {
+  auto block_cache = std::make_shared<BlockCache>(1 << 20);
+  SSTConfig config{.block_size_ = 1024, .block_cache_ = block_cache};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+  auto sst_ptr = std::make_shared<SST>(std::move(sst));
+
+  SSTIterator first_iter(sst_ptr);
+  SSTIterator second_iter(sst_ptr);
+  int count = 0;
+  while (first_iter.is_valid()) {
+    ASSERT_TRUE(second_iter.is_valid());
+    // both iterators view the same cached block buffer, nothing is copied
+    EXPECT_EQ(first_iter.value_view().data(), second_iter.value_view().data());
+    EXPECT_TRUE(std::ranges::equal(first_iter.key_view(),
+                                   second_iter.key_view()));
+    count++;
+    first_iter.next();
+    second_iter.next();
+  }
+  EXPECT_EQ(count, n_entries);
+  EXPECT_FALSE(second_iter.is_valid());
+}
+
+TEST_F(SSTTest, TestSSTGetBlocks) {
+  auto block_cache = std::make_shared<BlockCache>(1 << 20);
+  SSTConfig config{.block_size_ = 1024, .block_cache_ = block_cache};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+  ASSERT_GT(sst.number_of_block(), 4);
+
+  // block 2 is cached, the others are read in one batch
+  sst.get_block(2);
+  std::vector<size_t> block_idxs{3, 0, 1, 2};
+  auto blocks = sst.get_blocks(block_idxs);
+  ASSERT_EQ(blocks.size(), block_idxs.size());
+  EXPECT_EQ(block_cache->hits(), 1);
+  for (size_t i = 0; i < block_idxs.size(); i++) {
+    auto metadata = sst.get_block_metadata()[block_idxs[i]];
+    EXPECT_EQ(blocks[i]->get_first_key(), metadata.first_key_);
+    EXPECT_EQ(blocks[i]->get_last_key(), metadata.last_key_);
+    // the batch populated the cache
+    EXPECT_EQ(sst.get_block(block_idxs[i]), blocks[i]);
+  }
+}
+
+TEST_F(SSTTest, TestSSTMultiGet) {
+  auto block_cache = std::make_shared<BlockCache>(1 << 20);
+  SSTConfig config{.block_size_ = 1024, .block_cache_ = block_cache};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+
+  std::vector<std::vector<std::byte>> keys;
+  for (int i = 0; i < n_entries; i++) {
+    keys.push_back(MakeBytesVector("key" + std::to_string(i)));
+  }
+  keys.push_back(MakeBytesVector("key1x"));
+  std::ranges::sort(keys);
+  std::vector<std::span<const std::byte>> key_views(keys.begin(), keys.end());
+
+  auto values = sst.multi_get(key_views);
+  ASSERT_EQ(values.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    auto key = keys[i];
+    EXPECT_EQ(values[i], sst.get(key));
+  }
+  // every block was read once, the get() calls above hit the cache
+  EXPECT_EQ(block_cache->misses(), sst.number_of_block());
+}
+
+TEST_F(SSTTest, TestSSTMmapReadMode) {
+  auto block_cache = std::make_shared<BlockCache>(1 << 20);
+  SSTConfig config{.block_size_ = 1024,
+                   .block_cache_ = block_cache,
+                   .read_mode_ = SSTReadMode::MMAP};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+  EXPECT_EQ(sst.get_read_mode(), SSTReadMode::MMAP);
+
+  for (int i = 0; i < n_entries; i++) {
+    auto key_vec = MakeBytesVector("key" + std::to_string(i));
+    EXPECT_EQ(sst.get(key_vec), MakeBytesVector("value" + std::to_string(i)));
+  }
+  auto missing = MakeBytesVector("key1x");
+  EXPECT_FALSE(sst.get(missing).has_value());
+  // blocks are served from the mapping, the block cache is not used
+  EXPECT_EQ(block_cache->hits() + block_cache->misses(), 0);
+
+  auto sst_ptr = std::make_shared<SST>(std::move(sst));
+  {
+    SSTIterator first_iter(sst_ptr);
+    SSTIterator second_iter(sst_ptr);
+    int count = 0;
+    while (first_iter.is_valid()) {
+      // both iterators view the same mapped bytes
+      EXPECT_EQ(first_iter.value_view().data(),
+                second_iter.value_view().data());
+      count++;
+      first_iter.next();
+      second_iter.next();
+    }
+    EXPECT_EQ(count, n_entries);
+  }
+
+  // blocks keep the mapping alive after the SST is gone
+  auto block = sst_ptr->get_block(0);
+  sst_ptr.reset();
+  EXPECT_EQ(block->get_first_key(), MakeBytesVector("key0"));
+}
+
+TEST_F(SSTTest, TestSSTIoUringReadMode) {
+  SSTConfig config{.block_size_ = 1024, .read_mode_ = SSTReadMode::IO_URING};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+
+  std::vector<size_t> block_idxs(sst.number_of_block());
+  std::iota(block_idxs.rbegin(), block_idxs.rend(), 0);
+  auto blocks = sst.get_blocks(block_idxs);
+  auto block_metadata = sst.get_block_metadata();
+  for (size_t i = 0; i < block_idxs.size(); i++) {
+    EXPECT_EQ(blocks[i]->get_first_key(),
+              block_metadata[block_idxs[i]].first_key_);
+  }
+  for (int i = 0; i < n_entries; i++) {
+    auto key_vec = MakeBytesVector("key" + std::to_string(i));
+    EXPECT_EQ(sst.get(key_vec), MakeBytesVector("value" + std::to_string(i)));
+  }
+}
+
+TEST_F(SSTTest, TestSSTIteratorReadsAheadUnderIoUring) {
+  auto block_cache = std::make_shared<BlockCache>(1 << 20);
+  SSTConfig config{.block_size_ = 1024,
+                   .block_cache_ = block_cache,
+                   .read_mode_ = SSTReadMode::IO_URING};
+  int n_entries = 1000;
+  auto [sst, _] =
+      make_sst_table(n_entries, std::filesystem::path("sst_0"), config);
+  auto sst_ptr = std::make_shared<SST>(std::move(sst));
+  size_t readahead_blocks = SSTIterator::READAHEAD_BLOCKS;
+  ASSERT_GT(sst_ptr->number_of_block(), readahead_blocks + 1);
+
+  // the first block is read alone
+  SSTIterator sst_iter(sst_ptr);
+  EXPECT_EQ(block_cache->misses(), 1);
+
+  // moving on to the second block reads it and the blocks after it at once
+  auto second_block_key = sst_ptr->get_block_metadata()[1].first_key_;
+  int count = 0;
+  while (!std::ranges::equal(sst_iter.key_view(), second_block_key)) {
+    count++;
+    sst_iter.next();
+  }
+  EXPECT_EQ(block_cache->misses(), 1 + readahead_blocks);
+  sst_ptr->get_block(readahead_blocks);
+  EXPECT_EQ(block_cache->misses(), 1 + readahead_blocks);
+
+  while (sst_iter.is_valid()) {
+    count++;
+    sst_iter.next();
+  }
+  EXPECT_EQ(count, n_entries);
+  // every block was read once
+  EXPECT_EQ(block_cache->misses(), sst_ptr->number_of_block());
+}
@@ -0,0 +1,123 @@
+#include "sst/level_iterator.hpp"
+#include "sst/sst_builder.hpp"
+#include "sst/table_cache.hpp"
+#include "test_utilities.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using test_utils::MakeBytesVector;
+
+class TableCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::filesystem::create_directories(sst_directory_);
+    for (uint64_t sst_id = 1; sst_id <= 3; sst_id++) {
+      SSTConfig config{.block_size_ = 1024, .sst_directory_ = sst_directory_};
+      SSTBuilder builder(sst_directory_ / ("sst_" + std::to_string(sst_id)),
+                         config);
+      // SST i holds the keys k{i}0 .. k{i}9
+      for (int i = 0; i < 10; i++) {
+        auto key = MakeBytesVector("k" + std::to_string(sst_id * 10 + i));
+        auto value = MakeBytesVector("v" + std::to_string(sst_id * 10 + i));
+        builder.add_entry(key, value);
+      }
+      builder.build();
+    }
+  }
+
+  void TearDown() override { std::filesystem::remove_all(sst_directory_); }
+
+  const std::filesystem::path sst_directory_{"/tmp/mini_lsm_table_cache"};
+};
+
+TEST_F(TableCacheTest, OpensLazilyAndEvictsLeastRecentlyUsed) {
+  TableCache cache(sst_directory_, 2, nullptr, SSTReadMode::PREAD);
+  EXPECT_EQ(cache.size(), 0);
+
+  auto sst = cache.get(1);
+  auto key = MakeBytesVector("k12");
+  EXPECT_EQ(sst->get(key), MakeBytesVector("v12"));
+  EXPECT_EQ(cache.get(1), sst);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+
+  cache.get(2);
+  cache.get(3);
+  EXPECT_EQ(cache.size(), 2);
+  // SST 1 was evicted, it is reopened while the old handle stays usable
+  EXPECT_NE(cache.get(1), sst);
+  EXPECT_EQ(cache.misses(), 4);
+  EXPECT_EQ(sst->get(key), MakeBytesVector("v12"));
+
+  cache.evict(1);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST_F(TableCacheTest, ZeroCapacityCachesNothing) {
+  TableCache cache(sst_directory_, 0, nullptr, SSTReadMode::PREAD);
+  auto key = MakeBytesVector("k35");
+  EXPECT_EQ(cache.get(3)->get(key), MakeBytesVector("v35"));
+  EXPECT_EQ(cache.get(3)->get(key), MakeBytesVector("v35"));
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.hits(), 0);
+}
+
+TEST_F(TableCacheTest, HandleKeepsKeyRange) {
+  TableCache cache(sst_directory_, 4, nullptr, SSTReadMode::PREAD);
+  auto handle = SSTHandle::from_sst(*cache.get(2));
+  EXPECT_EQ(handle.id_, 2);
+  EXPECT_EQ(handle.smallest_key_, MakeBytesVector("k20"));
+  EXPECT_EQ(handle.largest_key_, MakeBytesVector("k29"));
+  EXPECT_EQ(handle.file_size_,
+            std::filesystem::file_size(cache.sst_path(2)));
+
+  EXPECT_TRUE(handle.may_contain(MakeBytesVector("k25")));
+  EXPECT_TRUE(handle.may_contain(MakeBytesVector("k29")));
+  EXPECT_FALSE(handle.may_contain(MakeBytesVector("k19")));
+  EXPECT_FALSE(handle.may_contain(MakeBytesVector("k3")));
+
+  EXPECT_TRUE(handle.overlaps(MakeBytesVector("k1"), MakeBytesVector("k21")));
+  EXPECT_TRUE(handle.overlaps(MakeBytesVector("k29"), {}));
+  EXPECT_FALSE(handle.overlaps(MakeBytesVector("k1"), MakeBytesVector("k20")));
+  EXPECT_FALSE(handle.overlaps(MakeBytesVector("k291"), {}));
+}
+
+TEST_F(TableCacheTest, LevelIteratorOpensOneSSTAtATime) {
+  // a capacity of 0 opens the SST again on every get, misses count the opens
+  auto cache = std::make_shared<TableCache>(sst_directory_, 0, nullptr,
+                                            SSTReadMode::PREAD);
+  std::vector<std::shared_ptr<const SSTHandle>> files;
+  for (uint64_t sst_id = 1; sst_id <= 3; sst_id++) {
+    files.push_back(std::make_shared<const SSTHandle>(
+        SSTHandle::from_sst(*cache->get(sst_id))));
+  }
+  auto opened = cache->misses();
+
+  LevelIterator iter(cache, files);
+  EXPECT_FALSE(iter.is_valid());
+  iter.seek(MakeBytesVector("k25"));
+  ASSERT_TRUE(iter.is_valid());
+  EXPECT_EQ(iter.key(), MakeBytesVector("k25"));
+  EXPECT_EQ(cache->misses() - opened, 1);
+
+  std::vector<std::vector<std::byte>> keys;
+  for (; iter.is_valid(); iter.next()) {
+    keys.push_back(iter.key());
+  }
+  ASSERT_EQ(keys.size(), 15);
+  EXPECT_EQ(keys[4], MakeBytesVector("k29"));
+  EXPECT_EQ(keys[5], MakeBytesVector("k30"));
+  EXPECT_EQ(keys.back(), MakeBytesVector("k39"));
+  // SST 1 is before the seek target and never opened
+  EXPECT_EQ(cache->misses() - opened, 2);
+
+  // a target between two files lands on the next one
+  iter.seek(MakeBytesVector("k2"));
+  ASSERT_TRUE(iter.is_valid());
+  EXPECT_EQ(iter.key(), MakeBytesVector("k20"));
+  iter.seek(MakeBytesVector("k4"));
+  EXPECT_FALSE(iter.is_valid());
+}
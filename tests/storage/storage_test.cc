@@ -2,8 +2,11 @@
 
 #include "storage.hpp"
 #include "test_utilities.hpp"
+#include <atomic>
 #include <chrono>
 #include <filesystem>
+#include <format>
+#include <fstream>
 #include <memory>
 #include <random>
 #include <thread>
@@ -22,7 +25,7 @@ protected:
   void TearDown() override {
     storage.reset();
     std::filesystem::remove_all(opt.sst_directory_);
-    std::filesystem::remove(opt.manifest_path_);
+    std::filesystem::remove_all(opt.manifest_directory_);
     std::filesystem::remove_all(opt.wal_directory_);
   }
   StorageOption opt{1024}; // 1KB memtable size
@@ -65,6 +68,34 @@ TEST_F(StorageBasicTest, GetNonExistentKey) {
   EXPECT_FALSE(result.has_value());
 }
 
+TEST_F(StorageBasicTest, ScanReturnsRangeInKeyOrder) {
+  for (int i = 0; i < 100; ++i) {
+    auto key = MakeBytesVector(std::format("key{:03}", i));
+    auto value = MakeBytesVector("value" + std::to_string(i));
+    storage->put(key, value);
+  }
+  auto removed = MakeBytesVector("key015");
+  storage->remove(removed);
+
+  auto iter =
+      storage->scan(MakeBytesVector("key010"), MakeBytesVector("key020"));
+  std::vector<std::string> keys;
+  for (; iter.is_valid(); iter.next()) {
+    keys.push_back(BytesToString(iter.key()));
+  }
+  std::vector<std::string> expected{"key010", "key011", "key012",
+                                    "key013", "key014", "key016",
+                                    "key017", "key018", "key019"};
+  EXPECT_EQ(keys, expected);
+
+  // no upper bound
+  int count = 0;
+  for (auto all = storage->scan({}, {}); all.is_valid(); all.next()) {
+    count++;
+  }
+  EXPECT_EQ(count, 99);
+}
+
 // ============================================================================
 // MEMTABLE FLUSH LOGIC
 // ============================================================================
@@ -78,7 +109,7 @@ protected:
   void TearDown() override {
     storage.reset();
     std::filesystem::remove_all(opt.sst_directory_);
-    std::filesystem::remove(opt.manifest_path_);
+    std::filesystem::remove_all(opt.manifest_directory_);
     std::filesystem::remove_all(opt.wal_directory_);
   }
 };
@@ -139,7 +170,7 @@ protected:
   void TearDown() override {
     storage.reset();
     std::filesystem::remove_all(opt.sst_directory_);
-    std::filesystem::remove(opt.manifest_path_);
+    std::filesystem::remove_all(opt.manifest_directory_);
     std::filesystem::remove_all(opt.wal_directory_);
   }
 };
@@ -214,7 +245,7 @@ protected:
   void TearDown() override {
     storage.reset();
     std::filesystem::remove_all(opt.sst_directory_);
-    std::filesystem::remove(opt.manifest_path_);
+    std::filesystem::remove_all(opt.manifest_directory_);
     std::filesystem::remove_all(opt.wal_directory_);
   }
 };
@@ -256,7 +287,7 @@ protected:
   void TearDown() override {
     storage.reset();
     std::filesystem::remove_all(opt.sst_directory_);
-    std::filesystem::remove(opt.manifest_path_);
+    std::filesystem::remove_all(opt.manifest_directory_);
     std::filesystem::remove_all(opt.wal_directory_);
   }
 };
@@ -314,7 +345,7 @@ protected:
   void TearDown() override {
     storage.reset();
     std::filesystem::remove_all(opt.sst_directory_);
-    std::filesystem::remove(opt.manifest_path_);
+    std::filesystem::remove_all(opt.manifest_directory_);
     std::filesystem::remove_all(opt.wal_directory_);
   }
 };
@@ -369,12 +400,52 @@ protected:
 
   void TearDown() override {
     storage_.reset();
+    remove_directories();
+    std::filesystem::remove_all(crash_directory_);
+  }
+
+  void remove_directories() {
     std::filesystem::remove_all(sst_directory_);
-    std::filesystem::remove(opt_.manifest_path_);
+    std::filesystem::remove_all(opt_.manifest_directory_);
     std::filesystem::remove_all(opt_.wal_directory_);
   }
 
+  // starts over on empty directories with the given options
+  void restart_with(const StorageOption &opt) {
+    storage_.reset();
+    remove_directories();
+    opt_ = opt;
+    std::filesystem::create_directories(sst_directory_);
+    storage_ = std::make_unique<Storage>(opt_);
+  }
+
+  // closes the storage and recovers it from the same directories
+  void reopen() {
+    storage_.reset();
+    storage_ = std::make_unique<Storage>(opt_);
+  }
+
+  // copies the directories of the open storage as a crash would leave them,
+  // nothing is flushed. Returns the options that open the copy.
+  StorageOption copy_crash_image() {
+    std::filesystem::remove_all(crash_directory_);
+    auto crash_opt = opt_;
+    crash_opt.sst_directory_ = crash_directory_ / "sst";
+    crash_opt.manifest_directory_ = crash_directory_ / "manifest";
+    crash_opt.wal_directory_ = crash_directory_ / "wal";
+    for (auto [from, to] :
+         {std::pair{opt_.sst_directory_, crash_opt.sst_directory_},
+          std::pair{opt_.manifest_directory_, crash_opt.manifest_directory_},
+          std::pair{opt_.wal_directory_, crash_opt.wal_directory_}}) {
+      std::filesystem::create_directories(to);
+      std::filesystem::copy(from, to);
+    }
+    return crash_opt;
+  }
+
   std::filesystem::path sst_directory_;
+  std::filesystem::path crash_directory_ =
+      std::filesystem::current_path() / "storage_flush_crash_test";
   std::unique_ptr<Storage> storage_;
   StorageOption opt_;
 };
@@ -457,3 +528,811 @@ TEST_F(StorageFlushRunTest, FlushMemtableAtClose) {
     }
   }
 }
+
+// ============================================================================
+// GROUP COMMIT
+// ============================================================================
+
+class StorageGroupCommitTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    opt_.mem_table_size_ = 16 * 1024;
+    opt_.wal_sync_option = WALSyncOption::SYNC_ON_WRITE;
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(opt_.sst_directory_);
+    std::filesystem::remove_all(opt_.manifest_directory_);
+    std::filesystem::remove_all(opt_.wal_directory_);
+  }
+
+  StorageOption opt_;
+};
+
+TEST_F(StorageGroupCommitTest, ConcurrentSyncWritesAreDurable) {
+  const int num_threads = 8;
+  const int puts_per_thread = 100;
+  {
+    Storage storage{opt_};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&storage, t, puts_per_thread]() {
+        for (int i = 0; i < puts_per_thread; ++i) {
+          auto key = MakeBytesVector("key" + std::to_string(t) + "_" +
+                                     std::to_string(i));
+          auto value = MakeBytesVector("value" + std::to_string(i));
+          storage.put(key, value);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    for (int t = 0; t < num_threads; ++t) {
+      for (int i = 0; i < puts_per_thread; ++i) {
+        auto key = MakeBytesVector("key" + std::to_string(t) + "_" +
+                                   std::to_string(i));
+        auto result = storage.get(key);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(BytesToString(result.value()), "value" + std::to_string(i));
+      }
+    }
+  }
+
+  Storage verify_storage{opt_};
+  for (int t = 0; t < num_threads; ++t) {
+    for (int i = 0; i < puts_per_thread; ++i) {
+      auto key = MakeBytesVector("key" + std::to_string(t) + "_" +
+                                 std::to_string(i));
+      auto result = verify_storage.get(key);
+      ASSERT_TRUE(result.has_value());
+      EXPECT_EQ(BytesToString(result.value()), "value" + std::to_string(i));
+    }
+  }
+}
+
+// ============================================================================
+// WRITE BATCH
+// ============================================================================
+
+TEST_F(StorageBasicTest, WriteBatchAppliesAllEntries) {
+  auto existing = MakeBytesVector("existing");
+  auto old_value = MakeBytesVector("old");
+  storage->put(existing, old_value);
+
+  WriteBatch batch;
+  for (int i = 0; i < 100; ++i) {
+    batch.put(MakeBytesVector("key" + std::to_string(i)),
+              MakeBytesVector("value" + std::to_string(i)));
+  }
+  batch.remove(existing);
+  // later entries of a batch win over earlier ones
+  batch.put(MakeBytesVector("key0"), MakeBytesVector("latest"));
+  storage->write(batch);
+
+  EXPECT_FALSE(storage->get(existing).has_value());
+  auto key0 = MakeBytesVector("key0");
+  EXPECT_EQ(BytesToString(storage->get(key0).value()), "latest");
+  for (int i = 1; i < 100; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto result = storage->get(key);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(BytesToString(result.value()), "value" + std::to_string(i));
+  }
+}
+
+TEST_F(StorageGroupCommitTest, WriteBatchIsDurable) {
+  {
+    Storage storage{opt_};
+    WriteBatch batch;
+    for (int i = 0; i < 200; ++i) {
+      batch.put(MakeBytesVector("key" + std::to_string(i)),
+                MakeBytesVector("value" + std::to_string(i)));
+    }
+    storage.write(batch);
+  }
+
+  Storage verify_storage{opt_};
+  for (int i = 0; i < 200; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto result = verify_storage.get(key);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(BytesToString(result.value()), "value" + std::to_string(i));
+  }
+}
+
+TEST_F(StorageGroupCommitTest, PeriodicSyncWritesAreRecovered) {
+  opt_.wal_sync_option = WALSyncOption::SYNC_PERIODIC;
+  opt_.wal_buffer_size_ = 256;
+  {
+    Storage storage{opt_};
+    for (int i = 0; i < 500; ++i) {
+      auto key = MakeBytesVector("key" + std::to_string(i));
+      auto value = MakeBytesVector("value" + std::to_string(i));
+      storage.put(key, value);
+    }
+  }
+
+  Storage verify_storage{opt_};
+  for (int i = 0; i < 500; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto result = verify_storage.get(key);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(BytesToString(result.value()), "value" + std::to_string(i));
+  }
+}
+
+// ============================================================================
+// FLUSH SCHEDULING
+// ============================================================================
+
+TEST_F(StorageFlushRunTest, FlushAllWithoutImmutableMemtablesIsANoOp) {
+  auto manifest_bytes = [&]() {
+    uint64_t bytes = 0;
+    for (auto &entry :
+         std::filesystem::directory_iterator(opt_.manifest_directory_)) {
+      bytes += entry.file_size();
+    }
+    return bytes;
+  };
+  auto before = manifest_bytes();
+  storage_->flush_run(true);
+  storage_->flush_run(true);
+  EXPECT_EQ(manifest_bytes(), before);
+  EXPECT_EQ(storage_->get_stats().flush_count_, 0);
+}
+
+TEST_F(StorageFlushRunTest, FlushScheduledWhenMemtableFrozen) {
+  EXPECT_EQ(storage_->get_stats().flush_count_, 0);
+
+  // freeze more memtables than max_number_of_memtable_
+  auto value = MakeBytesVector(std::string(1024, 'v'));
+  for (int i = 0; i < 32; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    storage_->put(key, value);
+  }
+
+  for (int i = 0; i < 1000 && storage_->get_stats().flush_count_ == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto stats = storage_->get_stats();
+  EXPECT_GT(stats.flush_count_, 0);
+  EXPECT_GE(stats.flush_lag_total_, stats.flush_lag_max_);
+
+  for (int i = 0; i < 32; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    ASSERT_TRUE(storage_->get(key).has_value());
+  }
+}
+
+TEST_F(StorageFlushRunTest, RecoveredMemtablesAboveTheLimitAreFlushed) {
+  auto opt = opt_;
+  opt.max_number_of_memtable_ = 100;
+  opt.immutable_memtable_soft_limit_ = 100;
+  opt.immutable_memtable_hard_limit_ = 200;
+  opt.wal_sync_option = WALSyncOption::SYNC_ON_WRITE;
+  restart_with(opt);
+
+  auto value = MakeBytesVector(std::string(1024, 'v'));
+  for (int i = 0; i < 32; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    storage_->put(key, value);
+  }
+  ASSERT_EQ(storage_->get_stats().flush_count_, 0);
+
+  // every frozen memtable comes back from its WAL, without any new write
+  // the recovery alone has to bring them under max_number_of_memtable_
+  auto crash_opt = copy_crash_image();
+  crash_opt.max_number_of_memtable_ = 2;
+  crash_opt.immutable_memtable_soft_limit_ = 4;
+  crash_opt.immutable_memtable_hard_limit_ = 8;
+  Storage recovered{crash_opt};
+  for (int i = 0; i < 1000 && recovered.get_stats().flush_count_ == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_GT(recovered.get_stats().flush_count_, 0);
+  for (int i = 0; i < 32; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    ASSERT_TRUE(recovered.get(key).has_value()) << i;
+  }
+}
+
+TEST_F(StorageFlushRunTest, ScanMergesMemtablesAndSSTsNewestFirst) {
+  // every round overwrites the keys, the older rounds end up in SSTs
+  constexpr int rounds = 10;
+  constexpr int n_keys = 200;
+  for (int round = 0; round < rounds; ++round) {
+    for (int i = 0; i < n_keys; ++i) {
+      auto key = MakeBytesVector(std::format("key{:04}", i));
+      auto value = MakeBytesVector(std::format("round{}", round));
+      storage_->put(key, value);
+    }
+  }
+  for (int i = 0; i < n_keys; i += 2) {
+    auto key = MakeBytesVector(std::format("key{:04}", i));
+    storage_->remove(key);
+  }
+  EXPECT_GT(storage_->get_stats().flush_count_, 0);
+
+  int expected_idx = 1;
+  for (auto iter = storage_->scan({}, {}); iter.is_valid(); iter.next()) {
+    EXPECT_EQ(BytesToString(iter.key()), std::format("key{:04}", expected_idx));
+    EXPECT_EQ(BytesToString(iter.value()),
+              std::format("round{}", rounds - 1));
+    expected_idx += 2;
+  }
+  EXPECT_EQ(expected_idx, n_keys + 1);
+}
+
+TEST_F(StorageFlushRunTest, RepeatedReadsHitBlockCache) {
+  // a compaction between the two rounds would move the keys to new SSTs,
+  // whose blocks are not cached yet
+  auto opt = opt_;
+  opt.level0_file_num_compaction_trigger_ = 1000;
+  restart_with(opt);
+
+  for (int i = 0; i < 500; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto value = MakeBytesVector(std::string(64, 'v'));
+    storage_->put(key, value);
+  }
+  for (int i = 0; i < 1000 && storage_->get_stats().flush_count_ == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_GT(storage_->get_stats().flush_count_, 0);
+
+  // the first keys went to the oldest memtable, which is flushed by now
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 10; ++i) {
+      auto key = MakeBytesVector("key" + std::to_string(i));
+      ASSERT_TRUE(storage_->get(key).has_value());
+    }
+  }
+  auto stats = storage_->get_stats();
+  EXPECT_GT(stats.block_cache_miss_count_, 0);
+  EXPECT_GT(stats.block_cache_hit_count_, stats.block_cache_miss_count_);
+}
+
+TEST_F(StorageFlushRunTest, MmapReadModeServesFlushedKeys) {
+  auto opt = opt_;
+  opt.sst_read_mode_ = SSTReadMode::MMAP;
+  restart_with(opt);
+
+  for (int i = 0; i < 500; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto value = MakeBytesVector(std::string(64, 'v'));
+    storage_->put(key, value);
+  }
+  for (int i = 0; i < 1000 && storage_->get_stats().flush_count_ == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_GT(storage_->get_stats().flush_count_, 0);
+
+  for (int i = 0; i < 500; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    ASSERT_TRUE(storage_->get(key).has_value());
+  }
+  int count = 0;
+  for (auto iter = storage_->scan({}, {}); iter.is_valid(); iter.next()) {
+    count++;
+  }
+  EXPECT_EQ(count, 500);
+  auto stats = storage_->get_stats();
+  EXPECT_EQ(stats.block_cache_hit_count_ + stats.block_cache_miss_count_, 0);
+}
+
+TEST_F(StorageFlushRunTest, ReadsNeverMissKeysDuringFlush) {
+  for (int i = 0; i < 100; ++i) {
+    auto key = MakeBytesVector("stable" + std::to_string(i));
+    auto value = MakeBytesVector("value" + std::to_string(i));
+    storage_->put(key, value);
+  }
+
+  // the writer keeps switching memtables and installing flushed SSTs while
+  // the readers look up keys that must be found in every snapshot
+  std::atomic<bool> writer_done{false};
+  std::atomic<int> misses{0};
+  std::thread writer([&]() {
+    auto value = MakeBytesVector(std::string(256, 'v'));
+    for (int i = 0; i < 2000; ++i) {
+      auto key = MakeBytesVector("new" + std::to_string(i));
+      storage_->put(key, value);
+    }
+    writer_done = true;
+  });
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t]() {
+      int i = t;
+      while (!writer_done) {
+        auto key = MakeBytesVector("stable" + std::to_string(i % 100));
+        if (!storage_->get(key).has_value()) {
+          misses++;
+        }
+        i += 7;
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(misses, 0);
+  EXPECT_GT(storage_->get_stats().flush_count_, 0);
+}
+
+TEST_F(StorageFlushRunTest, ReadersSeeWholeBatches) {
+  // every batch sets all the keys to the same round, a reader that sees two
+  // rounds at once saw part of a batch
+  const int n_keys = 16;
+  std::vector<std::vector<std::byte>> keys;
+  for (int i = 0; i < n_keys; ++i) {
+    keys.push_back(MakeBytesVector(std::format("key{:02}", i)));
+  }
+  auto write_round = [&](int round) {
+    WriteBatch batch;
+    for (auto &key : keys) {
+      batch.put(key, MakeBytesVector(std::format("round{:05}", round)));
+    }
+    storage_->write(batch);
+  };
+  write_round(0);
+
+  std::atomic<bool> writer_done{false};
+  std::atomic<int> torn_reads{0};
+  std::thread writer([&]() {
+    for (int round = 1; round < 2000; ++round) {
+      write_round(round);
+    }
+    writer_done = true;
+  });
+  std::vector<std::thread> readers;
+  readers.emplace_back([&]() {
+    while (!writer_done) {
+      auto values = storage_->multi_get(keys);
+      for (auto &value : values) {
+        if (!value.has_value() || value.value() != values.front().value()) {
+          torn_reads++;
+          break;
+        }
+      }
+    }
+  });
+  readers.emplace_back([&]() {
+    while (!writer_done) {
+      std::vector<std::vector<std::byte>> values;
+      for (auto iter = storage_->scan({}, {}); iter.is_valid(); iter.next()) {
+        values.push_back(iter.value());
+      }
+      if (values.size() != n_keys ||
+          std::ranges::count(values, values.front()) != n_keys) {
+        torn_reads++;
+      }
+    }
+  });
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(torn_reads, 0);
+}
+
+TEST_F(StorageFlushRunTest, CloseWaitsForQueuedWrites) {
+  // every put that returned before close must survive the reopen, the others
+  // fail with "storage stopped"
+  const int num_threads = 4;
+  std::vector<int> acked(num_threads, 0);
+  std::atomic<int> unexpected_errors{0};
+  std::atomic<int> started{0};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < num_threads; ++t) {
+    writers.emplace_back([&, t]() {
+      auto value = MakeBytesVector(std::string(64, 'v'));
+      started++;
+      for (int i = 0;; ++i) {
+        auto key = MakeBytesVector(std::format("t{}_key{:06}", t, i));
+        try {
+          storage_->put(key, value);
+        } catch (const std::runtime_error &e) {
+          if (std::string(e.what()) != "storage stopped") {
+            unexpected_errors++;
+          }
+          return;
+        }
+        acked[t] = i + 1;
+      }
+    });
+  }
+  while (started < num_threads) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  storage_->close();
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  EXPECT_EQ(unexpected_errors, 0);
+
+  reopen();
+  for (int t = 0; t < num_threads; ++t) {
+    EXPECT_GT(acked[t], 0);
+    for (int i = 0; i < acked[t]; ++i) {
+      auto key = MakeBytesVector(std::format("t{}_key{:06}", t, i));
+      ASSERT_TRUE(storage_->get(key).has_value()) << t << " " << i;
+    }
+  }
+}
+
+TEST_F(StorageFlushRunTest, WritesStallUntilFlushCatchesUp) {
+  auto opt = opt_;
+  // the background flush alone would keep every memtable in memory
+  opt.max_number_of_memtable_ = 100;
+  opt.immutable_memtable_soft_limit_ = 2;
+  opt.immutable_memtable_hard_limit_ = 4;
+  opt.max_write_delay_ = std::chrono::microseconds{100};
+  restart_with(opt);
+
+  auto value = MakeBytesVector(std::string(1024, 'v'));
+  for (int i = 0; i < 64; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    storage_->put(key, value);
+  }
+
+  auto stats = storage_->get_stats();
+  EXPECT_GT(stats.write_delay_count_, 0);
+  EXPECT_GT(stats.write_stop_count_, 0);
+  EXPECT_GT(stats.flush_count_, 0);
+  for (int i = 0; i < 64; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    ASSERT_TRUE(storage_->get(key).has_value());
+  }
+}
+
+TEST_F(StorageFlushRunTest, ParallelFlushKeepsNewestFirstOrder) {
+  auto opt = opt_;
+  opt.max_background_flushes = 4;
+  opt.max_number_of_memtable_ = 0;
+  restart_with(opt);
+
+  // every round overwrites the same keys and freezes at least one memtable,
+  // so the flushed SSTs all hold different versions of the keys.
+  constexpr int rounds = 20;
+  constexpr int n_keys = 50;
+  for (int round = 0; round < rounds; ++round) {
+    for (int i = 0; i < n_keys; ++i) {
+      auto key = MakeBytesVector("key" + std::to_string(i));
+      auto value = MakeBytesVector("round" + std::to_string(round) +
+                                   std::string(64, 'v'));
+      storage_->put(key, value);
+    }
+  }
+  // every memtable is flushed on close, empty the WALs so that the reopened
+  // storage serves the reads from the SSTs only
+  storage_.reset();
+  for (auto &entry :
+       std::filesystem::directory_iterator(opt_.wal_directory_)) {
+    std::filesystem::resize_file(entry.path(), 0);
+  }
+
+  Storage verify_storage{opt_};
+  for (int i = 0; i < n_keys; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto result = verify_storage.get(key);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(BytesToString(result.value()),
+              "round" + std::to_string(rounds - 1) + std::string(64, 'v'));
+  }
+}
+
+TEST_F(StorageFlushRunTest, MultiGetMatchesGet) {
+  for (int i = 0; i < 600; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto value = MakeBytesVector("value" + std::to_string(i));
+    storage_->put(key, value);
+  }
+  storage_->flush_run(true);
+  // newer versions in the memtables shadow the flushed ones
+  for (int i = 0; i < 600; i += 3) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto value = MakeBytesVector("new_value" + std::to_string(i));
+    storage_->put(key, value);
+  }
+  for (int i = 1; i < 600; i += 5) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    storage_->remove(key);
+  }
+
+  std::vector<std::vector<std::byte>> keys;
+  for (int i = 700; i >= 0; --i) {
+    keys.push_back(MakeBytesVector("key" + std::to_string(i)));
+  }
+  keys.push_back(MakeBytesVector("key42"));
+  auto values = storage_->multi_get(keys);
+  ASSERT_EQ(values.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(values[i], storage_->get(keys[i])) << BytesToString(keys[i]);
+  }
+  EXPECT_EQ(BytesToString(values.back().value()), "new_value42");
+  EXPECT_TRUE(storage_->multi_get({}).empty());
+}
+
+TEST_F(StorageFlushRunTest, TableCacheBoundsOpenSSTs) {
+  auto opt = opt_;
+  opt.table_cache_capacity_ = 1;
+  restart_with(opt);
+
+  for (int i = 0; i < 2000; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto value = MakeBytesVector("value" + std::to_string(i));
+    storage_->put(key, value);
+  }
+  storage_->flush_run(true);
+
+  for (int i = 0; i < 2000; ++i) {
+    auto key = MakeBytesVector("key" + std::to_string(i));
+    auto result = storage_->get(key);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(BytesToString(result.value()), "value" + std::to_string(i));
+  }
+  int count = 0;
+  for (auto iter = storage_->scan({}, {}); iter.is_valid(); iter.next()) {
+    count++;
+  }
+  EXPECT_EQ(count, 2000);
+  // only one SST stays open, the others are reopened on demand
+  EXPECT_GT(storage_->get_stats().table_cache_miss_count_, 1);
+}
+
+TEST_F(StorageFlushRunTest, LeveledCompactionReclaimsOverwrittenKeys) {
+  auto opt = opt_;
+  opt.num_levels_ = 4;
+  opt.level0_file_num_compaction_trigger_ = 2;
+  opt.max_bytes_for_level_base_ = 16 * 1024;
+  opt.target_file_size_ = 8 * 1024;
+  restart_with(opt);
+
+  auto expected = [](int round, int i) -> std::optional<std::string> {
+    if (round == 2 && i % 7 == 0) {
+      return std::nullopt;
+    }
+    return std::format("value{}_{}", round, i);
+  };
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 1000; ++i) {
+      auto key = MakeBytesVector(std::format("key{:04}", i));
+      auto value = expected(round, i);
+      if (value.has_value()) {
+        auto value_bytes = MakeBytesVector(std::move(value.value()));
+        storage_->put(key, value_bytes);
+      } else {
+        storage_->remove(key);
+      }
+    }
+    storage_->flush_run(true);
+  }
+  storage_->compact_run();
+
+  auto stats = storage_->get_stats();
+  EXPECT_GT(stats.compaction_count_, 0);
+  EXPECT_GT(stats.compaction_bytes_written_, 0);
+  ASSERT_EQ(stats.level_file_count_.size(), 4);
+  EXPECT_LT(stats.level_file_count_[0], 2);
+  // the compaction inputs were deleted, only the live SSTs are left
+  uint64_t live_files = 0;
+  for (auto count : stats.level_file_count_) {
+    live_files += count;
+  }
+  EXPECT_EQ(std::distance(std::filesystem::directory_iterator(sst_directory_),
+                          std::filesystem::directory_iterator{}),
+            live_files);
+
+  auto check = [&]() {
+    int count = 0;
+    for (int i = 0; i < 1000; ++i) {
+      auto key = MakeBytesVector(std::format("key{:04}", i));
+      auto value = storage_->get(key);
+      auto expected_value = expected(2, i);
+      ASSERT_EQ(value.has_value(), expected_value.has_value()) << i;
+      if (value.has_value()) {
+        EXPECT_EQ(BytesToString(value.value()), expected_value.value());
+        count++;
+      }
+    }
+    int scanned = 0;
+    for (auto iter = storage_->scan({}, {}); iter.is_valid(); iter.next()) {
+      scanned++;
+    }
+    EXPECT_EQ(scanned, count);
+  };
+  check();
+
+  // the manifest records the levels and the deleted SSTs
+  reopen();
+  stats = storage_->get_stats();
+  EXPECT_GT(stats.level_file_count_[1] + stats.level_file_count_[2] +
+                stats.level_file_count_[3],
+            0);
+  check();
+}
+
+TEST_F(StorageFlushRunTest, TieredCompactionMergesSortedRuns) {
+  auto opt = opt_;
+  opt.compaction_style_ = CompactionStyle::TIERED;
+  opt.num_levels_ = 4;
+  opt.level0_file_num_compaction_trigger_ = 3;
+  opt.target_file_size_ = 8 * 1024;
+  restart_with(opt);
+
+  // every round overwrites the even keys and adds new ones
+  for (int round = 0; round < 6; ++round) {
+    for (int i = 0; i < 500; ++i) {
+      int key_id = i % 2 == 0 ? i : round * 1000 + i;
+      auto key = MakeBytesVector(std::format("key{:05}", key_id));
+      auto value = MakeBytesVector(std::format("value{}_{}", round, i));
+      storage_->put(key, value);
+    }
+    storage_->flush_run(true);
+  }
+  storage_->compact_run();
+
+  auto sorted_runs = [&]() {
+    auto stats = storage_->get_stats();
+    uint64_t runs = stats.level_file_count_[0];
+    for (size_t level = 1; level < stats.level_file_count_.size(); level++) {
+      runs += stats.level_file_count_[level] > 0;
+    }
+    return runs;
+  };
+  auto stats = storage_->get_stats();
+  EXPECT_GT(stats.compaction_count_, 0);
+  EXPECT_GT(stats.flush_bytes_written_, 0);
+  EXPECT_LT(sorted_runs(), 3);
+
+  auto check = [&]() {
+    for (int round = 0; round < 6; ++round) {
+      for (int i = 0; i < 500; ++i) {
+        int key_id = i % 2 == 0 ? i : round * 1000 + i;
+        auto key = MakeBytesVector(std::format("key{:05}", key_id));
+        auto value = storage_->get(key);
+        ASSERT_TRUE(value.has_value()) << key_id;
+        EXPECT_EQ(BytesToString(value.value()),
+                  std::format("value{}_{}", i % 2 == 0 ? 5 : round, i));
+      }
+    }
+    int scanned = 0;
+    for (auto iter = storage_->scan({}, {}); iter.is_valid(); iter.next()) {
+      scanned++;
+    }
+    EXPECT_EQ(scanned, 250 + 6 * 250);
+  };
+  check();
+
+  reopen();
+  storage_->compact_run();
+  EXPECT_LT(sorted_runs(), 3);
+  check();
+}
+
+TEST_F(StorageFlushRunTest, SubcompactionsKeepEveryKey) {
+  auto opt = opt_;
+  opt.num_levels_ = 3;
+  opt.level0_file_num_compaction_trigger_ = 2;
+  opt.target_file_size_ = 8 * 1024;
+  opt.max_subcompactions_ = 4;
+  restart_with(opt);
+
+  for (int round = 0; round < 4; ++round) {
+    for (int i = 0; i < 1000; ++i) {
+      auto key = MakeBytesVector(std::format("key{:04}", i));
+      auto value = MakeBytesVector(std::format("value{}_{}", round, i));
+      storage_->put(key, value);
+    }
+    storage_->flush_run(true);
+  }
+  storage_->compact_run();
+
+  auto stats = storage_->get_stats();
+  EXPECT_GT(stats.compaction_count_, 0);
+  EXPECT_LT(stats.level_file_count_[0], 2);
+  for (int i = 0; i < 1000; ++i) {
+    auto key = MakeBytesVector(std::format("key{:04}", i));
+    auto value = storage_->get(key);
+    ASSERT_TRUE(value.has_value()) << i;
+    EXPECT_EQ(BytesToString(value.value()), std::format("value3_{}", i));
+  }
+  int scanned = 0;
+  for (auto iter = storage_->scan({}, {}); iter.is_valid(); iter.next()) {
+    scanned++;
+  }
+  EXPECT_EQ(scanned, 1000);
+}
+
+TEST_F(StorageFlushRunTest, FlushedWALsAreDeletedAndNotReplayed) {
+  auto wal_count = [&]() {
+    return std::distance(
+        std::filesystem::directory_iterator(opt_.wal_directory_),
+        std::filesystem::directory_iterator{});
+  };
+  for (int i = 0; i < 500; ++i) {
+    auto key = MakeBytesVector(std::format("key{:03}", i));
+    auto value = MakeBytesVector(std::format("value{}", i));
+    storage_->put(key, value);
+  }
+  storage_->flush_run(true);
+  // only the WAL of the active memtable is left
+  EXPECT_EQ(wal_count(), 1);
+
+  // close flushes the active memtable too
+  storage_.reset();
+  EXPECT_EQ(wal_count(), 0);
+  // a flushed WAL a crash left behind is deleted, not replayed
+  {
+    std::ofstream leftover(opt_.wal_directory_ / "1.wal");
+    leftover << "not a WAL";
+  }
+  storage_ = std::make_unique<Storage>(opt_);
+  EXPECT_FALSE(std::filesystem::exists(opt_.wal_directory_ / "1.wal"));
+  for (int i = 0; i < 500; ++i) {
+    auto key = MakeBytesVector(std::format("key{:03}", i));
+    auto value = storage_->get(key);
+    ASSERT_TRUE(value.has_value()) << i;
+    EXPECT_EQ(BytesToString(value.value()), std::format("value{}", i));
+  }
+}
+
+TEST_F(StorageFlushRunTest, ManifestIsRewrittenAsASnapshot) {
+  auto opt = opt_;
+  opt.level0_file_num_compaction_trigger_ = 2;
+  opt.max_manifest_file_size_ = 1024;
+  opt.wal_sync_option = WALSyncOption::SYNC_ON_WRITE;
+  restart_with(opt);
+
+  for (int round = 0; round < 4; ++round) {
+    for (int i = 0; i < 500; ++i) {
+      auto key = MakeBytesVector(std::format("key{:03}", i));
+      auto value = MakeBytesVector(std::format("value{}_{}", round, i));
+      storage_->put(key, value);
+    }
+    storage_->flush_run(true);
+    storage_->compact_run();
+  }
+  // the last writes only live in the active memtable and its WAL
+  for (int i = 0; i < 10; ++i) {
+    auto key = MakeBytesVector(std::format("key{:03}", i));
+    auto value = MakeBytesVector(std::format("value4_{}", i));
+    storage_->put(key, value);
+  }
+
+  // the old manifests are deleted once CURRENT points at the snapshot
+  auto manifest_files = [](const std::filesystem::path &directory) {
+    return std::distance(std::filesystem::directory_iterator(directory),
+                         std::filesystem::directory_iterator{});
+  };
+  EXPECT_EQ(manifest_files(opt_.manifest_directory_), 2);
+  EXPECT_FALSE(std::filesystem::exists(opt_.manifest_directory_ /
+                                       "MANIFEST-000001"));
+
+  // the memtable is only in the WAL the snapshot points at
+  auto crash_opt = copy_crash_image();
+
+  auto check = [](Storage &storage) {
+    for (int i = 0; i < 500; ++i) {
+      auto key = MakeBytesVector(std::format("key{:03}", i));
+      auto value = storage.get(key);
+      ASSERT_TRUE(value.has_value()) << i;
+      EXPECT_EQ(BytesToString(value.value()),
+                std::format("value{}_{}", i < 10 ? 4 : 3, i));
+    }
+  };
+  {
+    Storage crashed{crash_opt};
+    EXPECT_EQ(manifest_files(crash_opt.manifest_directory_), 2);
+    check(crashed);
+  }
+
+  reopen();
+  EXPECT_EQ(manifest_files(opt_.manifest_directory_), 2);
+  check(*storage_);
+}
@@ -0,0 +1,61 @@
+#include "thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+class ThreadPoolTest : public ::testing::Test {};
+
+TEST_F(ThreadPoolTest, ReturnsTaskResults) {
+  ThreadPool pool{4};
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.emplace_back(pool.submit([i]() { return i * i; }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(futures[i].get(), i * i);
+  }
+}
+
+TEST_F(ThreadPoolTest, RunsTasksConcurrently) {
+  ThreadPool pool{2};
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 2; ++i) {
+    futures.emplace_back(pool.submit([&]() {
+      int curr = running.fetch_add(1) + 1;
+      int prev = max_running.load();
+      while (prev < curr && !max_running.compare_exchange_weak(prev, curr)) {
+      }
+      // wait for the other task to start
+      for (int spin = 0; spin < 1000 && running.load() < 2; ++spin) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      running.fetch_sub(1);
+    }));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+  EXPECT_EQ(max_running.load(), 2);
+}
+
+TEST_F(ThreadPoolTest, PropagatesExceptions) {
+  ThreadPool pool{1};
+  auto future =
+      pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+  EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST_F(ThreadPoolTest, DestructorDrainsQueuedTasks) {
+  std::atomic<int> done{0};
+  {
+    ThreadPool pool{1};
+    for (int i = 0; i < 50; ++i) {
+      pool.submit([&done]() { done.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(done.load(), 50);
+}
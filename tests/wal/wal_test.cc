@@ -1,7 +1,12 @@
+#include "memtable.hpp"
 #include "test_utilities.hpp"
 #include "wal/wal.hpp"
+#include "write_batch.hpp"
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <memory>
+#include <thread>
 #include <vector>
 
 using test_utils::MakeBytesVector;
@@ -32,3 +37,110 @@ TEST_F(WALTest, AddRecordTest) {
   auto decoded_record = WAL::read_wal(wal_path_);
   EXPECT_EQ(records, decoded_record);
 }
+
+TEST_F(WALTest, AddBatchesAndSyncTest) {
+  WriteBatch batch1, batch2;
+  batch1.put(MakeBytesVector("key_1"), MakeBytesVector("value_1"));
+  batch1.remove(MakeBytesVector("key_2"));
+  batch2.put(MakeBytesVector("key_3"), MakeBytesVector("value_3"));
+  std::vector<const WriteBatch *> batches{&batch1, &batch2};
+  wal_->add_batches_and_sync(batches);
+  wal_.reset();
+
+  std::vector<WALRecord> expected{
+      {MakeBytesVector("key_1"), MakeBytesVector("value_1")},
+      {MakeBytesVector("key_2"), MakeBytesVector("")},
+      {MakeBytesVector("key_3"), MakeBytesVector("value_3")},
+  };
+  EXPECT_EQ(WAL::read_wal(wal_path_), expected);
+}
+
+TEST_F(WALTest, BufferedBatchWrittenOnClose) {
+  WriteBatch batch;
+  batch.put(MakeBytesVector("key_1"), MakeBytesVector("value_1"));
+  batch.put(MakeBytesVector("key_2"), MakeBytesVector("value_2"));
+  wal_->add_batch(batch);
+  wal_.reset();
+
+  EXPECT_EQ(WAL::read_wal(wal_path_), batch.records());
+}
+
+TEST_F(WALTest, TornBatchIsDropped) {
+  WriteBatch batch1, batch2;
+  batch1.put(MakeBytesVector("key_1"), MakeBytesVector("value_1"));
+  batch2.put(MakeBytesVector("key_2"), MakeBytesVector("value_2"));
+  batch2.put(MakeBytesVector("key_3"), MakeBytesVector("value_3"));
+  std::vector<const WriteBatch *> batches{&batch1};
+  wal_->add_batches_and_sync(batches);
+  batches = {&batch2};
+  wal_->add_batches_and_sync(batches);
+  wal_.reset();
+
+  // simulate a crash in the middle of writing the second batch
+  auto full_size = std::filesystem::file_size(wal_path_);
+  std::filesystem::resize_file(wal_path_, full_size - 3);
+
+  EXPECT_EQ(WAL::read_wal(wal_path_), batch1.records());
+
+  auto mem_table = MemTable::recover(wal_path_, 1, 4096);
+  EXPECT_TRUE(mem_table->get(MakeBytesVector("key_1")).has_value());
+  EXPECT_FALSE(mem_table->get(MakeBytesVector("key_2")).has_value());
+  EXPECT_FALSE(mem_table->get(MakeBytesVector("key_3")).has_value());
+}
+
+TEST_F(WALTest, CorruptedBatchIsDropped) {
+  WriteBatch batch1, batch2;
+  batch1.put(MakeBytesVector("key_1"), MakeBytesVector("value_1"));
+  batch2.put(MakeBytesVector("key_2"), MakeBytesVector("value_2"));
+  std::vector<const WriteBatch *> batches{&batch1, &batch2};
+  wal_->add_batches_and_sync(batches);
+  wal_.reset();
+
+  // flip the last byte of the second batch's value
+  {
+    std::fstream file(wal_path_,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-1, std::ios::end);
+    file.put('X');
+  }
+
+  EXPECT_EQ(WAL::read_wal(wal_path_), batch1.records());
+}
+
+TEST_F(WALTest, BufferWrittenOnceThresholdReached) {
+  wal_.reset();
+  std::filesystem::remove(wal_path_);
+  wal_ = std::make_unique<WAL>(wal_path_, WALConfig{.buffer_size_ = 64});
+
+  WriteBatch small;
+  small.put(MakeBytesVector("k"), MakeBytesVector("v"));
+  wal_->add_batch(small);
+  EXPECT_EQ(std::filesystem::file_size(wal_path_), 0);
+
+  WriteBatch large;
+  large.put(MakeBytesVector("key"), MakeBytesVector(std::string(100, 'v')));
+  wal_->add_batch(large);
+  EXPECT_GT(std::filesystem::file_size(wal_path_), 100);
+
+  std::vector<WALRecord> expected = small.records();
+  expected.append_range(large.records());
+  EXPECT_EQ(WAL::read_wal(wal_path_), expected);
+}
+
+TEST_F(WALTest, PeriodicSyncWritesInBackground) {
+  wal_.reset();
+  std::filesystem::remove(wal_path_);
+  wal_ = std::make_unique<WAL>(
+      wal_path_, WALConfig{.sync_option_ = WALSyncOption::SYNC_PERIODIC,
+                           .sync_interval_ = std::chrono::milliseconds(5)});
+
+  WriteBatch batch;
+  batch.put(MakeBytesVector("key_1"), MakeBytesVector("value_1"));
+  wal_->add_batch(batch);
+
+  // the background thread writes the buffered frame without a close
+  for (int i = 0; i < 200 && std::filesystem::file_size(wal_path_) == 0; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(WAL::read_wal(wal_path_), batch.records());
+}
@@ -0,0 +1,63 @@
+#include "write_controller.hpp"
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+class WriteControllerTest : public ::testing::Test {
+protected:
+  WriteController controller_{
+      WriteControllerConfig{.immutable_memtable_soft_limit_ = 4,
+                            .immutable_memtable_hard_limit_ = 8,
+                            .pending_bytes_soft_limit_ = 1000,
+                            .pending_bytes_hard_limit_ = 2000,
+                            .l0_sst_soft_limit_ = 0,
+                            .l0_sst_hard_limit_ = 10,
+                            .max_delay_ = 1000us}};
+};
+
+TEST_F(WriteControllerTest, NoStallBelowSoftLimits) {
+  WritePressure pressure{
+      .immutable_memtables_ = 3, .pending_bytes_ = 999, .l0_ssts_ = 9};
+  EXPECT_EQ(controller_.get_stall(pressure), WriteStall::NONE);
+  EXPECT_EQ(controller_.get_delay(pressure), 0us);
+}
+
+TEST_F(WriteControllerTest, DelayGrowsTowardsHardLimit) {
+  std::chrono::microseconds prev_delay{0};
+  for (uint64_t count = 4; count < 8; ++count) {
+    WritePressure pressure{.immutable_memtables_ = count};
+    EXPECT_EQ(controller_.get_stall(pressure), WriteStall::DELAYED);
+    auto delay = controller_.get_delay(pressure);
+    EXPECT_GT(delay, prev_delay);
+    EXPECT_LE(delay, 1000us);
+    prev_delay = delay;
+  }
+}
+
+TEST_F(WriteControllerTest, WorstMetricDecides) {
+  WritePressure pressure{.immutable_memtables_ = 4, .pending_bytes_ = 1900};
+  EXPECT_EQ(controller_.get_stall(pressure), WriteStall::DELAYED);
+  EXPECT_GT(controller_.get_delay(pressure),
+            controller_.get_delay(WritePressure{.immutable_memtables_ = 4}));
+}
+
+TEST_F(WriteControllerTest, StopAtHardLimit) {
+  EXPECT_EQ(controller_.get_stall(WritePressure{.immutable_memtables_ = 8}),
+            WriteStall::STOPPED);
+  EXPECT_EQ(controller_.get_stall(WritePressure{.pending_bytes_ = 2000}),
+            WriteStall::STOPPED);
+  // l0_sst_soft_limit_ is disabled, only the hard limit applies
+  EXPECT_EQ(controller_.get_stall(WritePressure{.l0_ssts_ = 9}),
+            WriteStall::NONE);
+  EXPECT_EQ(controller_.get_stall(WritePressure{.l0_ssts_ = 10}),
+            WriteStall::STOPPED);
+  EXPECT_EQ(controller_.get_delay(WritePressure{.l0_ssts_ = 10}), 0us);
+}
+
+TEST_F(WriteControllerTest, DisabledLimitsNeverStall) {
+  WriteController controller;
+  WritePressure pressure{.immutable_memtables_ = 1000,
+                         .pending_bytes_ = 1ULL << 40,
+                         .l0_ssts_ = 1000};
+  EXPECT_EQ(controller.get_stall(pressure), WriteStall::NONE);
+}